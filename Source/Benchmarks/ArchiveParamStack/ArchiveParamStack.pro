@@ -0,0 +1,40 @@
+#-------------------------------------------------
+#
+# Measures IArchive's per-parameter overhead with and without ARCHIVE_FULL_PARAM_STACK.
+# The setting changes the layout of IArchive, so LibCommon has to be built with the same value:
+#   qmake ARCHIVE_FULL_PARAM_STACK=0 (or 1) for both LibCommon.pro and this project
+#
+#-------------------------------------------------
+
+QT -= core gui
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+BUILD_DIR = $$PWD/../../../Build
+EXTERNALS_DIR = $$PWD/../../../Externals
+DESTDIR = $$BUILD_DIR
+
+!isEmpty(ARCHIVE_FULL_PARAM_STACK): DEFINES += ARCHIVE_FULL_PARAM_STACK=$$ARCHIVE_FULL_PARAM_STACK
+
+CONFIG (debug, debug|release) {
+    # Debug Config
+    OBJECTS_DIR = $$BUILD_DIR/debug/ArchiveParamStack
+    TARGET = ArchiveParamStackd
+    LIBS += -L$$BUILD_DIR -lLibCommond
+}
+
+CONFIG (release, debug|release) {
+    # Release Config
+    OBJECTS_DIR = $$BUILD_DIR/release/ArchiveParamStack
+    TARGET = ArchiveParamStack
+    LIBS += -L$$BUILD_DIR -lLibCommon
+}
+
+# Include Paths
+INCLUDEPATH += $$PWD/../.. \
+               $$EXTERNALS_DIR/CodeGen/include
+
+# Source Files
+SOURCES += \
+    main.cpp
@@ -0,0 +1,70 @@
+#include "Common/Common.h"
+#include "Common/CTimer.h"
+#include "Common/Serialization/CBasicBinaryReader.h"
+#include "Common/Serialization/CBasicBinaryWriter.h"
+#include <cstdio>
+
+/**
+ * Round-trips a million-element vector through CBasicBinaryWriter/CBasicBinaryReader with memory
+ * streams and reports the best time per element. Elements are structs rather than scalars, so each
+ * one is its own parameter instead of going through SerializeBulkScalars. Basic binary archives
+ * don't write parameter names or sizes, so what's left is mostly IArchive's own per-parameter cost.
+ */
+struct SElement
+{
+    uint32 Value;
+
+    void Serialize(IArchive& rArc)
+    {
+        rArc << SerialParameter("Value", Value);
+    }
+};
+
+static const uint32 gkNumElements = 1000000;
+static const uint32 gkNumRuns = 15;
+
+int main()
+{
+    std::vector<SElement> Source(gkNumElements);
+
+    for (uint32 ElemIdx = 0; ElemIdx < gkNumElements; ElemIdx++)
+        Source[ElemIdx].Value = ElemIdx * 2654435761u;
+
+    CSerialVersion Version(IArchive::skCurrentArchiveVersion, 0, EGame::Invalid);
+    std::vector<char> Data;
+    double BestWrite = 1e9, BestRead = 1e9;
+
+    for (uint32 RunIdx = 0; RunIdx < gkNumRuns; RunIdx++)
+    {
+        Data.clear();
+        double StartTime = CTimer::GlobalTime();
+        {
+            CVectorOutStream Stream(&Data, EEndian::LittleEndian);
+            CBasicBinaryWriter Writer(&Stream, Version);
+            Writer << SerialParameter("Elements", Source);
+        }
+        double WriteTime = CTimer::GlobalTime() - StartTime;
+
+        std::vector<SElement> Result;
+        StartTime = CTimer::GlobalTime();
+        {
+            CBasicBinaryReader Reader(Data.data(), Data.size(), Version, EEndian::LittleEndian);
+            Reader << SerialParameter("Elements", Result);
+        }
+        double ReadTime = CTimer::GlobalTime() - StartTime;
+
+        if (Result.size() != gkNumElements || Result.back().Value != Source.back().Value)
+        {
+            printf("Round trip failed\n");
+            return 1;
+        }
+
+        if (WriteTime < BestWrite) BestWrite = WriteTime;
+        if (ReadTime < BestRead) BestRead = ReadTime;
+    }
+
+    printf("ARCHIVE_FULL_PARAM_STACK=%d, %u elements, best of %u runs\n", ARCHIVE_FULL_PARAM_STACK, gkNumElements, gkNumRuns);
+    printf("  write: %6.1f ns/element\n", BestWrite * 1e9 / gkNumElements);
+    printf("  read:  %6.1f ns/element\n", BestRead * 1e9 / gkNumElements);
+    return 0;
+}
@@ -65,10 +65,10 @@ void CColor::Write(IOutputStream &rOutput, bool Integral /*= false*/) const
 
 void CColor::Serialize(IArchive& rArc)
 {
-    rArc << SerialParameter("R", R)
-         << SerialParameter("G", G)
-         << SerialParameter("B", B)
-         << SerialParameter("A", A, SH_Optional, 1.0f);
+    rArc << SerialParameter(SERIAL_NAME("R"), R)
+         << SerialParameter(SERIAL_NAME("G"), G)
+         << SerialParameter(SERIAL_NAME("B"), B)
+         << SerialParameter(SERIAL_NAME("A"), A, SH_Optional, 1.0f);
 }
 
 long CColor::ToLongRGBA() const
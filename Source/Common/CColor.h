@@ -62,5 +62,6 @@ public:
     static const CColor skTransparentBlack;
     static const CColor skTransparentGray;
 };
+DECLARE_BULK_SERIAL_TYPE(CColor, float, 4)
 
 #endif // CCOLOR_H
@@ -5,13 +5,21 @@
 
 #include "FileIO/IInputStream.h"
 #include "FileIO/CFileInStream.h"
+#include "FileIO/CMappedFileInStream.h"
+#include "FileIO/CPrefetchFileInStream.h"
+#include "FileIO/CSharedFileInStream.h"
 #include "FileIO/CMemoryInStream.h"
+#include "FileIO/CSubInStream.h"
 
 #include "FileIO/IOutputStream.h"
 #include "FileIO/CFileOutStream.h"
 #include "FileIO/CMemoryOutStream.h"
+#include "FileIO/CSegmentedOutStream.h"
 #include "FileIO/CVectorOutStream.h"
 
 #include "FileIO/CBitStreamInWrapper.h"
+#include "FileIO/CBitStreamOutWrapper.h"
+#include "FileIO/CCompressedInStream.h"
+#include "FileIO/CCompressedOutStream.h"
 
 #endif // FILEIO
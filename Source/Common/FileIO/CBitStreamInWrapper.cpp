@@ -1,4 +1,5 @@
 #include "CBitStreamInWrapper.h"
+#include "Common/Macros.h"
 
 CBitStreamInWrapper::CBitStreamInWrapper(IInputStream *pStream, EChunkSize ChunkSize /*= e32Bit*/)
     : mpSourceStream(pStream)
@@ -13,38 +14,15 @@ void CBitStreamInWrapper::SetChunkSize(EChunkSize Size)
     mChunkSize = Size;
 }
 
-long CBitStreamInWrapper::ReadBits(uint32 NumBits, bool ExtendSignBit /*= true*/)
+int32 CBitStreamInWrapper::ReadBits(uint32 NumBits, bool ExtendSignBit /*= true*/)
 {
-    uint32 BitsRemaining = NumBits;
-    uint32 Out = 0;
-    uint32 Shift = 0;
-
-    while (BitsRemaining > 0)
-    {
-        if (mBitsRemaining < BitsRemaining)
-        {
-            BitsRemaining -= mBitsRemaining;
-            Out |= (mBitPool << Shift);
-            Shift += mBitsRemaining;
-            ReplenishPool();
-        }
-
-        else
-        {
-            long Mask = (1 << BitsRemaining) - 1;
-            Out |= (mBitPool & Mask) << Shift;
-            mBitPool >>= BitsRemaining;
-            mBitsRemaining -= BitsRemaining;
-            BitsRemaining = 0;
-        }
-    }
-
-    if (ExtendSignBit)
-    {
-        bool Sign = ((Out >> (NumBits - 1) & 0x1) == 1);
-        if (Sign) Out |= (-1 << NumBits);
-    }
+    ASSERT(NumBits <= 32);
+    if (NumBits == 0) return 0;
 
+    Refill(NumBits);
+    int32 Out = ExtractBits(mBitPool, NumBits, ExtendSignBit);
+    mBitPool >>= NumBits;
+    mBitsRemaining -= NumBits;
     return Out;
 }
 
@@ -53,15 +31,21 @@ bool CBitStreamInWrapper::ReadBit()
     return (ReadBits(1, false) != 0);
 }
 
-// ************ PRIVATE ************
-void CBitStreamInWrapper::ReplenishPool()
+void CBitStreamInWrapper::ReadBitsArray(uint32 Count, uint32 NumBits, int32 *pOut, bool ExtendSignBit /*= true*/)
 {
-    if (mChunkSize == k8Bit)
-        mBitPool = mpSourceStream->ReadByte();
-    else if (mChunkSize == k16Bit)
-        mBitPool = mpSourceStream->ReadShort();
-    else if (mChunkSize == k32Bit)
-        mBitPool = mpSourceStream->ReadLong();
+    ASSERT(NumBits <= 32);
+
+    if (NumBits == 0)
+    {
+        memset(pOut, 0, Count * sizeof(int32));
+        return;
+    }
 
-    mBitsRemaining = mChunkSize;
+    for (uint32 ValIdx = 0; ValIdx < Count; ValIdx++)
+    {
+        Refill(NumBits);
+        pOut[ValIdx] = ExtractBits(mBitPool, NumBits, ExtendSignBit);
+        mBitPool >>= NumBits;
+        mBitsRemaining -= NumBits;
+    }
 }
@@ -12,19 +12,50 @@ public:
     };
 
 private:
+    // Bits are consumed from the bottom of the accumulator, and new chunks are added on top of
+    // whatever is left. Chunks are only pulled from the source when a read needs them, so the
+    // source position matches reading one chunk at a time.
     IInputStream *mpSourceStream;
     EChunkSize mChunkSize;
-    uint32 mBitPool;
+    uint64 mBitPool;
     uint32 mBitsRemaining;
 
 public:
     CBitStreamInWrapper(IInputStream *pStream, EChunkSize ChunkSize = k32Bit);
     void SetChunkSize(EChunkSize Size);
-    long ReadBits(uint32 NumBits, bool ExtendSignBit = true);
+    int32 ReadBits(uint32 NumBits, bool ExtendSignBit = true);
     bool ReadBit();
+    void ReadBitsArray(uint32 Count, uint32 NumBits, int32 *pOut, bool ExtendSignBit = true);
 
 private:
-    void ReplenishPool();
+    inline void Refill(uint32 NumBits)
+    {
+        // Refills are inline stream reads, so they come straight out of the stream's read window
+        while (mBitsRemaining < NumBits)
+        {
+            uint64 Chunk;
+
+            if (mChunkSize == k8Bit)
+                Chunk = (uint8) mpSourceStream->ReadByte();
+            else if (mChunkSize == k16Bit)
+                Chunk = (uint16) mpSourceStream->ReadShort();
+            else
+                Chunk = (uint32) mpSourceStream->ReadLong();
+
+            mBitPool |= Chunk << mBitsRemaining;
+            mBitsRemaining += mChunkSize;
+        }
+    }
+
+    static inline int32 ExtractBits(uint64 Pool, uint32 NumBits, bool ExtendSignBit)
+    {
+        uint32 Val = (uint32) (Pool & ((1ULL << NumBits) - 1));
+
+        // Shift the top bit of the value up to bit 31 and arithmetic shift it back down
+        uint32 SignShift = 32 - NumBits;
+        int32 Extended = (int32) (Val << SignShift) >> SignShift;
+        return (ExtendSignBit ? Extended : (int32) Val);
+    }
 };
 
 #endif // CBITSTREAMINWRAPPER_H
@@ -0,0 +1,56 @@
+#include "CBitStreamOutWrapper.h"
+#include "Common/Macros.h"
+
+CBitStreamOutWrapper::CBitStreamOutWrapper(IOutputStream *pStream, EChunkSize ChunkSize /*= k32Bit*/)
+    : mpDestStream(pStream)
+    , mChunkSize(ChunkSize)
+    , mBitPool(0)
+    , mBitsUsed(0)
+{
+}
+
+void CBitStreamOutWrapper::SetChunkSize(EChunkSize Size)
+{
+    mChunkSize = Size;
+}
+
+void CBitStreamOutWrapper::WriteBits(uint32 Val, uint32 NumBits)
+{
+    ASSERT(NumBits <= 32);
+    mBitPool |= ((uint64) Val & ((1ULL << NumBits) - 1)) << mBitsUsed;
+    mBitsUsed += NumBits;
+    FlushChunks();
+}
+
+void CBitStreamOutWrapper::WriteBit(bool Val)
+{
+    WriteBits(Val ? 1 : 0, 1);
+}
+
+void CBitStreamOutWrapper::WriteBitsArray(uint32 Count, uint32 NumBits, const int32 *pkVals)
+{
+    ASSERT(NumBits <= 32);
+    uint64 Mask = (1ULL << NumBits) - 1;
+
+    for (uint32 ValIdx = 0; ValIdx < Count; ValIdx++)
+    {
+        mBitPool |= ((uint64) (uint32) pkVals[ValIdx] & Mask) << mBitsUsed;
+        mBitsUsed += NumBits;
+        FlushChunks();
+    }
+}
+
+void CBitStreamOutWrapper::Flush()
+{
+    FlushChunks();
+
+    if (mBitsUsed > 0)
+    {
+        // The unused bits are already zero, so just round up to a full chunk
+        mBitsUsed = mChunkSize;
+        FlushChunks();
+    }
+
+    mBitPool = 0;
+    mBitsUsed = 0;
+}
@@ -0,0 +1,51 @@
+#ifndef CBITSTREAMOUTWRAPPER_H
+#define CBITSTREAMOUTWRAPPER_H
+
+#include "IOutputStream.h"
+
+/**
+ * Writes packed bit streams that CBitStreamInWrapper can read back with the same chunk size.
+ * Bits are added on top of a 64-bit accumulator and written out one chunk at a time as chunks
+ * fill up. Call Flush() when done to write out the last partial chunk, padded with zeroes.
+ */
+class CBitStreamOutWrapper
+{
+public:
+    enum EChunkSize
+    {
+        k8Bit = 8, k16Bit = 16, k32Bit = 32
+    };
+
+private:
+    IOutputStream *mpDestStream;
+    EChunkSize mChunkSize;
+    uint64 mBitPool;
+    uint32 mBitsUsed;
+
+public:
+    CBitStreamOutWrapper(IOutputStream *pStream, EChunkSize ChunkSize = k32Bit);
+    void SetChunkSize(EChunkSize Size);
+    void WriteBits(uint32 Val, uint32 NumBits);
+    void WriteBit(bool Val);
+    void WriteBitsArray(uint32 Count, uint32 NumBits, const int32 *pkVals);
+    void Flush();
+
+private:
+    inline void FlushChunks()
+    {
+        while (mBitsUsed >= (uint32) mChunkSize)
+        {
+            if (mChunkSize == k8Bit)
+                mpDestStream->WriteByte((int8) mBitPool);
+            else if (mChunkSize == k16Bit)
+                mpDestStream->WriteShort((int16) mBitPool);
+            else
+                mpDestStream->WriteLong((int32) mBitPool);
+
+            mBitPool >>= mChunkSize;
+            mBitsUsed -= mChunkSize;
+        }
+    }
+};
+
+#endif // CBITSTREAMOUTWRAPPER_H
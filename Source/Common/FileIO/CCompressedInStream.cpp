@@ -0,0 +1,256 @@
+#include "CCompressedInStream.h"
+#include "Common/Macros.h"
+
+CCompressedInStream::CCompressedInStream(IInputStream *pSource)
+    : mpSource(pSource)
+    , mSourceStart(0)
+    , mCodec(ECompressionCodec::None)
+    , mBlockSize(0)
+    , mSize(0)
+    , mIsValid(false)
+    , mCurrentBlock(skNoBlock)
+    , mBlockOffset(0)
+{
+    ASSERT(mpSource && mpSource->IsValid());
+    mDataEndianness = mpSource->GetEndianness();
+    SetSourceString(mpSource->GetSourceString());
+
+    EEndian SourceEndianness = mpSource->GetEndianness();
+    mpSource->SetEndianness(EEndian::LittleEndian);
+    mIsValid = ReadIndex();
+    mpSource->SetEndianness(SourceEndianness);
+
+    if (mIsValid)
+        mBlock.resize(mBlockSize);
+}
+
+CCompressedInStream::~CCompressedInStream()
+{
+}
+
+void CCompressedInStream::ReadBytes(void *pDst, uint32 Count)
+{
+    if (!IsValid()) return;
+    uint8 *pOut = (uint8*) pDst;
+
+    while (Count > 0)
+    {
+        uint32 Buffered = (uint32) (mpReadLimit - mpReadCursor);
+
+        if (Buffered > 0)
+        {
+            uint32 CopySize = (Count < Buffered ? Count : Buffered);
+            memcpy(pOut, mpReadCursor, CopySize);
+            mpReadCursor += CopySize;
+            pOut += CopySize;
+            Count -= CopySize;
+        }
+
+        else
+        {
+            uint32 NextBlock = (mCurrentBlock == skNoBlock ? (uint32) (mBlockOffset / mBlockSize) : mCurrentBlock + 1);
+
+            if (NextBlock >= mBlocks.size() || !LoadBlock(NextBlock))
+                break;
+        }
+    }
+}
+
+bool CCompressedInStream::Seek64(int64 Offset, uint32 Origin)
+{
+    if (!IsValid()) return false;
+    int64 NewPos;
+
+    switch (Origin)
+    {
+        case SEEK_SET:
+            NewPos = Offset;
+            break;
+
+        case SEEK_CUR:
+            NewPos = (int64) Tell64() + Offset;
+            break;
+
+        case SEEK_END:
+            NewPos = (int64) mSize + Offset;
+            break;
+
+        default:
+            return false;
+    }
+
+    if (NewPos < 0 || NewPos > (int64) mSize)
+        return false;
+
+    // Seeks within the loaded block just move the cursor. Anything else drops the block; the new one is
+    // only decompressed once it's actually read from.
+    if (mCurrentBlock != skNoBlock && (uint64) NewPos / mBlockSize == mCurrentBlock)
+        mpReadCursor = mBlock.data() + (NewPos - mBlockOffset);
+    else
+        UnloadBlock(NewPos);
+
+    return true;
+}
+
+uint64 CCompressedInStream::Tell64() const
+{
+    if (mCurrentBlock == skNoBlock)
+        return mBlockOffset;
+    else
+        return mBlockOffset + (mpReadCursor - mBlock.data());
+}
+
+bool CCompressedInStream::EoF() const
+{
+    return (Tell64() >= mSize);
+}
+
+bool CCompressedInStream::IsValid() const
+{
+    return mIsValid;
+}
+
+uint64 CCompressedInStream::Size64() const
+{
+    return mSize;
+}
+
+// ************ PRIVATE ************
+bool CCompressedInStream::ReadIndex()
+{
+    // Everything below comes from the file, so it's all checked before it's used to size or index anything
+    mSourceStart = mpSource->Tell64();
+    uint64 SourceEnd = mpSource->Size64();
+
+    if (SourceEnd < mSourceStart || SourceEnd - mSourceStart < gkCompressedStreamHeaderSize + gkCompressedStreamTrailerSize)
+    {
+        errorf("%s: Compressed stream is truncated", *GetSourceString());
+        return false;
+    }
+
+    if (mpSource->ReadFourCC() != gkCompressedStreamMagic)
+    {
+        errorf("%s: Not a compressed stream", *GetSourceString());
+        return false;
+    }
+
+    mCodec = (ECompressionCodec) mpSource->ReadLong();
+    mBlockSize = mpSource->ReadLong();
+
+    if (mBlockSize == 0 || mBlockSize > gkMaxCompressedBlockSize)
+    {
+        errorf("%s: Invalid compressed stream block size: %d", *GetSourceString(), mBlockSize);
+        return false;
+    }
+
+    // The trailer sits at the very end of the source
+    uint64 IndexEnd = SourceEnd - mSourceStart - gkCompressedStreamTrailerSize;
+    mpSource->GoTo(mSourceStart + IndexEnd);
+    mSize = mpSource->ReadLongLong();
+    uint64 IndexOffset = mpSource->ReadLongLong();
+    uint32 NumBlocks = mpSource->ReadLong();
+
+    if (mpSource->ReadFourCC() != gkCompressedStreamMagic)
+    {
+        errorf("%s: Compressed stream trailer is missing", *GetSourceString());
+        return false;
+    }
+
+    if (!IsCodecSupported(mCodec))
+    {
+        errorf("%s: Compression codec %d is not supported in this build", *GetSourceString(), (int) mCodec);
+        return false;
+    }
+
+    // The index has to sit between the header and the trailer, and have one entry per block of mSize
+    uint64 ExpectedBlocks = (mSize / mBlockSize) + (mSize % mBlockSize != 0 ? 1 : 0);
+
+    if (NumBlocks != ExpectedBlocks ||
+        IndexOffset < gkCompressedStreamHeaderSize ||
+        IndexOffset > IndexEnd ||
+        (IndexEnd - IndexOffset) / sizeof(uint32) < NumBlocks)
+    {
+        errorf("%s: Compressed stream block index is corrupt", *GetSourceString());
+        return false;
+    }
+
+    std::vector<uint32> BlockSizes(NumBlocks);
+    mpSource->GoTo(mSourceStart + IndexOffset);
+    mpSource->ReadArray((int32*) BlockSizes.data(), NumBlocks);
+
+    mBlocks.resize(NumBlocks);
+    uint64 BlockOffset = gkCompressedStreamHeaderSize;
+
+    for (uint32 BlockIdx = 0; BlockIdx < NumBlocks; BlockIdx++)
+    {
+        SBlockInfo& rInfo = mBlocks[BlockIdx];
+        rInfo.Offset = BlockOffset;
+        rInfo.CompressedSize = BlockSizes[BlockIdx] & ~gkStoredBlockFlag;
+        rInfo.IsStored = (BlockSizes[BlockIdx] & gkStoredBlockFlag) != 0;
+        BlockOffset += rInfo.CompressedSize;
+
+        if (rInfo.CompressedSize > mBlockSize || BlockOffset > IndexOffset)
+        {
+            errorf("%s: Compressed stream block %d is corrupt", *GetSourceString(), BlockIdx);
+            mBlocks.clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool CCompressedInStream::LoadBlock(uint32 BlockIdx)
+{
+    const SBlockInfo& rkInfo = mBlocks[BlockIdx];
+
+    if (rkInfo.CompressedSize > mBlock.size())
+    {
+        errorf("%s: Compressed stream block %d is larger than the block size", *GetSourceString(), BlockIdx);
+        mIsValid = false;
+        return false;
+    }
+
+    uint64 UncompressedOffset = (uint64) BlockIdx * mBlockSize;
+    uint64 Remaining = mSize - UncompressedOffset;
+    uint32 UncompressedSize = (Remaining < mBlockSize ? (uint32) Remaining : mBlockSize);
+
+    mpSource->GoTo(mSourceStart + rkInfo.Offset);
+    bool Success;
+
+    if (rkInfo.IsStored)
+    {
+        mpSource->ReadBytes(mBlock.data(), rkInfo.CompressedSize);
+        Success = (rkInfo.CompressedSize == UncompressedSize);
+    }
+    else
+    {
+        mCompressBuffer.resize(rkInfo.CompressedSize);
+        mpSource->ReadBytes(mCompressBuffer.data(), rkInfo.CompressedSize);
+        Success = DecompressBlock(mCodec, mCompressBuffer.data(), rkInfo.CompressedSize, mBlock.data(), UncompressedSize);
+    }
+
+    if (!Success)
+    {
+        errorf("%s: Failed to decompress block %d", *GetSourceString(), BlockIdx);
+        return false;
+    }
+
+    // Keep the position if it's inside this block; otherwise start at the beginning of it
+    uint64 Position = Tell64();
+    uint32 BlockPos = (Position >= UncompressedOffset && Position - UncompressedOffset <= UncompressedSize ? (uint32) (Position - UncompressedOffset) : 0);
+
+    mCurrentBlock = BlockIdx;
+    mBlockOffset = UncompressedOffset;
+    mpReadCursor = mBlock.data() + BlockPos;
+    mpReadLimit = mBlock.data() + UncompressedSize;
+    return true;
+}
+
+void CCompressedInStream::UnloadBlock(uint64 Position)
+{
+    mCurrentBlock = skNoBlock;
+    mBlockOffset = Position;
+    mpReadCursor = nullptr;
+    mpReadLimit = nullptr;
+}
@@ -0,0 +1,55 @@
+#ifndef CCOMPRESSEDINSTREAM_H
+#define CCOMPRESSEDINSTREAM_H
+
+#include "IInputStream.h"
+#include "Compression.h"
+#include <vector>
+
+/**
+ * Input stream decorator that reads data written by CCompressedOutStream. Blocks are
+ * decompressed on demand into a buffer that backs the read window, and the block index
+ * makes seeking anywhere in the stream cost at most one block decompression.
+ * The source stream must be positioned at the start of the compressed data, and the
+ * compressed data must run to the end of the source.
+ */
+class CCompressedInStream : public IInputStream
+{
+    static const uint32 skNoBlock = 0xFFFFFFFF;
+
+    IInputStream *mpSource;
+    uint64 mSourceStart;
+    ECompressionCodec mCodec;
+    uint32 mBlockSize;
+    uint64 mSize;
+    bool mIsValid;
+
+    struct SBlockInfo
+    {
+        uint64 Offset; // Relative to mSourceStart
+        uint32 CompressedSize;
+        bool IsStored;
+    };
+    std::vector<SBlockInfo> mBlocks;
+
+    std::vector<uint8> mBlock;
+    std::vector<uint8> mCompressBuffer;
+    uint32 mCurrentBlock;
+    uint64 mBlockOffset; // Uncompressed offset of the buffered block; the current position if none is loaded
+
+    bool ReadIndex();
+    bool LoadBlock(uint32 BlockIdx);
+    void UnloadBlock(uint64 Position);
+
+public:
+    CCompressedInStream(IInputStream *pSource);
+    ~CCompressedInStream();
+
+    void ReadBytes(void *pDst, uint32 Count);
+    bool Seek64(int64 Offset, uint32 Origin);
+    uint64 Tell64() const;
+    bool EoF() const;
+    bool IsValid() const;
+    uint64 Size64() const;
+};
+
+#endif // CCOMPRESSEDINSTREAM_H
@@ -0,0 +1,155 @@
+#include "CCompressedOutStream.h"
+#include "Common/Macros.h"
+
+CCompressedOutStream::CCompressedOutStream(IOutputStream *pSink, ECompressionCodec Codec, uint32 BlockSize /*= 0x40000*/)
+    : mpSink(pSink)
+    , mSinkStart(0)
+    , mCodec(Codec)
+    , mBlockSize(BlockSize)
+    , mIsOpen(false)
+    , mBlockOffset(0)
+    , mBlockPos(0)
+    , mBlockUsed(0)
+{
+    ASSERT(mpSink && mpSink->IsValid());
+    ASSERT(mBlockSize > 0 && mBlockSize <= gkMaxCompressedBlockSize);
+    mDataEndianness = mpSink->GetEndianness();
+
+    if (!IsCodecSupported(mCodec))
+    {
+        errorf("Compression codec %d is not supported in this build; storing data uncompressed", (int) mCodec);
+        mCodec = ECompressionCodec::None;
+    }
+
+    mSinkStart = mpSink->Tell64();
+    EEndian SinkEndianness = mpSink->GetEndianness();
+    mpSink->SetEndianness(EEndian::LittleEndian);
+    mpSink->WriteFourCC(gkCompressedStreamMagic);
+    mpSink->WriteLong((uint32) mCodec);
+    mpSink->WriteLong(mBlockSize);
+    mpSink->SetEndianness(SinkEndianness);
+
+    mBlock.resize(mBlockSize);
+    mIsOpen = true;
+}
+
+CCompressedOutStream::~CCompressedOutStream()
+{
+    if (IsValid())
+        Close();
+}
+
+void CCompressedOutStream::Close()
+{
+    if (!IsValid()) return;
+
+    if (mBlockUsed > 0)
+        FlushBlock();
+
+    // Write the block index and trailer
+    EEndian SinkEndianness = mpSink->GetEndianness();
+    mpSink->SetEndianness(EEndian::LittleEndian);
+    uint64 IndexOffset = mpSink->Tell64() - mSinkStart;
+
+    mpSink->WriteArray((const int32*) mBlockIndex.data(), (uint32) mBlockIndex.size());
+    mpSink->WriteLongLong(mBlockOffset);
+    mpSink->WriteLongLong(IndexOffset);
+    mpSink->WriteLong((uint32) mBlockIndex.size());
+    mpSink->WriteFourCC(gkCompressedStreamMagic);
+    mpSink->SetEndianness(SinkEndianness);
+
+    mIsOpen = false;
+}
+
+void CCompressedOutStream::WriteBytes(const void *pkSrc, uint32 Count)
+{
+    if (!IsValid()) return;
+    const uint8 *pkData = (const uint8*) pkSrc;
+
+    while (Count > 0)
+    {
+        // Only compress the block once something is written past it, so it can still be seeked back into until then
+        if (mBlockPos == mBlockSize)
+            FlushBlock();
+
+        uint32 Space = mBlockSize - mBlockPos;
+        uint32 CopySize = (Count < Space ? Count : Space);
+        memcpy(mBlock.data() + mBlockPos, pkData, CopySize);
+
+        mBlockPos += CopySize;
+        if (mBlockPos > mBlockUsed) mBlockUsed = mBlockPos;
+        pkData += CopySize;
+        Count -= CopySize;
+    }
+}
+
+bool CCompressedOutStream::Seek64(int64 Offset, uint32 Origin)
+{
+    if (!IsValid()) return false;
+    int64 NewPos;
+
+    switch (Origin)
+    {
+        case SEEK_SET:
+            NewPos = Offset;
+            break;
+
+        case SEEK_CUR:
+            NewPos = (int64) Tell64() + Offset;
+            break;
+
+        case SEEK_END:
+            NewPos = (int64) Size64() + Offset;
+            break;
+
+        default:
+            return false;
+    }
+
+    // Only the uncompressed block can be seeked into
+    if (NewPos < (int64) mBlockOffset || NewPos > (int64) (mBlockOffset + mBlockUsed))
+        return false;
+
+    mBlockPos = (uint32) (NewPos - mBlockOffset);
+    return true;
+}
+
+uint64 CCompressedOutStream::Tell64() const
+{
+    return mBlockOffset + mBlockPos;
+}
+
+bool CCompressedOutStream::EoF() const
+{
+    return (mBlockPos == mBlockUsed);
+}
+
+bool CCompressedOutStream::IsValid() const
+{
+    return mIsOpen;
+}
+
+uint64 CCompressedOutStream::Size64() const
+{
+    return mBlockOffset + mBlockUsed;
+}
+
+// ************ PRIVATE ************
+void CCompressedOutStream::FlushBlock()
+{
+    if (CompressBlock(mCodec, mBlock.data(), mBlockUsed, mCompressBuffer))
+    {
+        mpSink->WriteBytes(mCompressBuffer.data(), (uint32) mCompressBuffer.size());
+        mBlockIndex.push_back((uint32) mCompressBuffer.size());
+    }
+    else
+    {
+        // Incompressible (or uncompressed stream); store it as-is
+        mpSink->WriteBytes(mBlock.data(), mBlockUsed);
+        mBlockIndex.push_back(mBlockUsed | gkStoredBlockFlag);
+    }
+
+    mBlockOffset += mBlockUsed;
+    mBlockPos = 0;
+    mBlockUsed = 0;
+}
@@ -0,0 +1,46 @@
+#ifndef CCOMPRESSEDOUTSTREAM_H
+#define CCOMPRESSEDOUTSTREAM_H
+
+#include "IOutputStream.h"
+#include "Compression.h"
+#include <vector>
+
+/**
+ * Output stream decorator that compresses everything written to it in fixed-size blocks and
+ * writes the blocks to another stream, followed by a block index for random access on read.
+ * Blocks are compressed as they fill up, so the sink is only ever written to sequentially.
+ * Seeking is only possible within the block that hasn't been compressed yet; data that
+ * needs to be backpatched further back should be built in memory first.
+ * The compressed data is finalized on Close(), which the destructor calls if needed.
+ */
+class CCompressedOutStream : public IOutputStream
+{
+    IOutputStream *mpSink;
+    uint64 mSinkStart; // Offsets in the index are relative to where the compressed data starts in the sink
+    ECompressionCodec mCodec;
+    uint32 mBlockSize;
+    bool mIsOpen;
+
+    std::vector<uint8> mBlock;
+    std::vector<uint8> mCompressBuffer;
+    uint64 mBlockOffset; // Uncompressed offset of the current block
+    uint32 mBlockPos;
+    uint32 mBlockUsed;
+    std::vector<uint32> mBlockIndex;
+
+    void FlushBlock();
+
+public:
+    CCompressedOutStream(IOutputStream *pSink, ECompressionCodec Codec, uint32 BlockSize = 0x40000);
+    ~CCompressedOutStream();
+    void Close();
+
+    void WriteBytes(const void *pkSrc, uint32 Count);
+    bool Seek64(int64 Offset, uint32 Origin);
+    uint64 Tell64() const;
+    bool EoF() const;
+    bool IsValid() const;
+    uint64 Size64() const;
+};
+
+#endif // CCOMPRESSEDOUTSTREAM_H
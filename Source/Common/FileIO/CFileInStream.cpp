@@ -1,29 +1,32 @@
 #include "CFileInStream.h"
+#include "Common/Macros.h"
 
 CFileInStream::CFileInStream()
     : mpFStream(nullptr)
+    , mFileSize(0)
+    , mBufferOffset(0)
 {
 }
 
 CFileInStream::CFileInStream(const TString& rkFile)
-    : mpFStream(nullptr)
+    : CFileInStream()
 {
     Open(rkFile, EEndian::BigEndian);
 }
 
 CFileInStream::CFileInStream(const TString& rkFile, EEndian FileEndianness)
-    : mpFStream(nullptr)
+    : CFileInStream()
 {
     Open(rkFile, FileEndianness);
 }
 
 CFileInStream::CFileInStream(const CFileInStream& rkSrc)
-    : mpFStream(nullptr)
+    : CFileInStream()
 {
     Open(rkSrc.mName, rkSrc.mDataEndianness);
 
     if (rkSrc.IsValid())
-        Seek(rkSrc.Tell(), SEEK_SET);
+        Seek64(rkSrc.Tell64(), SEEK_SET);
 }
 
 CFileInStream::~CFileInStream()
@@ -43,9 +46,15 @@ void CFileInStream::Open(const TString& rkFile, EEndian FileEndianness)
 
     if (IsValid())
     {
-        Seek(0x0, SEEK_END);
-        mFileSize = Tell();
-        Seek(0x0, SEEK_SET);
+        // We do our own buffering, so stdio's would only add an extra copy.
+        // setvbuf has to come before any other operation on the stream.
+        setvbuf(mpFStream, nullptr, _IONBF, 0);
+
+        _fseeki64(mpFStream, 0, SEEK_END);
+        mFileSize = (uint64) _ftelli64(mpFStream);
+        _fseeki64(mpFStream, 0, SEEK_SET);
+        mBuffer.resize(skBufferSize);
+        DiscardBuffer(0);
     }
     else
         mFileSize = 0;
@@ -58,41 +67,99 @@ void CFileInStream::Close()
     if (IsValid())
         fclose(mpFStream);
     mpFStream = nullptr;
+    mpReadCursor = nullptr;
+    mpReadLimit = nullptr;
+    mBufferOffset = 0;
 }
 
 void CFileInStream::ReadBytes(void *pDst, uint32 Count)
 {
     if (!IsValid()) return;
-    fread(pDst, 1, Count, mpFStream);
-}
+    uint8 *pOut = (uint8*) pDst;
 
-bool CFileInStream::Seek(int32 Offset, uint32 Origin)
-{
-    if (!IsValid()) return false;
-    return (fseek(mpFStream, Offset, Origin) != 0);
+    while (Count > 0)
+    {
+        // Drain whatever is left in the buffer first
+        uint32 Buffered = (uint32) (mpReadLimit - mpReadCursor);
+
+        if (Buffered > 0)
+        {
+            uint32 CopySize = (Count < Buffered ? Count : Buffered);
+            memcpy(pOut, mpReadCursor, CopySize);
+            mpReadCursor += CopySize;
+            pOut += CopySize;
+            Count -= CopySize;
+        }
+
+        // Large reads bypass the buffer and go straight to the destination
+        else if (Count >= skBufferSize)
+        {
+            uint64 Offset = Tell64();
+            size_t NumRead = fread(pOut, 1, Count, mpFStream);
+            DiscardBuffer(Offset + NumRead);
+            break;
+        }
+
+        else
+        {
+            FillBuffer();
+            if (mpReadCursor == mpReadLimit) break;
+        }
+    }
 }
 
 bool CFileInStream::Seek64(int64 Offset, uint32 Origin)
 {
     if (!IsValid()) return false;
-    return (_fseeki64(mpFStream, Offset, Origin) != 0);
-}
+    int64 NewPos;
 
-uint32 CFileInStream::Tell() const
-{
-    if (!IsValid()) return 0;
-    return ftell(mpFStream);
+    switch (Origin)
+    {
+        case SEEK_SET:
+            NewPos = Offset;
+            break;
+
+        case SEEK_CUR:
+            NewPos = (int64) Tell64() + Offset;
+            break;
+
+        case SEEK_END:
+            NewPos = (int64) mFileSize + Offset;
+            break;
+
+        default:
+            return false;
+    }
+
+    if (NewPos < 0)
+        return false;
+
+    // Seeks that land inside the buffer just move the cursor
+    const uint8 *pkBufferStart = mBuffer.data();
+    uint64 BufferEnd = mBufferOffset + (mpReadLimit - pkBufferStart);
+
+    if ((uint64) NewPos >= mBufferOffset && (uint64) NewPos <= BufferEnd)
+    {
+        mpReadCursor = pkBufferStart + (NewPos - mBufferOffset);
+        return true;
+    }
+
+    if (_fseeki64(mpFStream, NewPos, SEEK_SET) != 0)
+        return false;
+
+    DiscardBuffer(NewPos);
+    return true;
 }
 
 uint64 CFileInStream::Tell64() const
 {
     if (!IsValid()) return 0;
-    return _ftelli64(mpFStream);
+    return mBufferOffset + (mpReadCursor - mBuffer.data());
 }
 
 bool CFileInStream::EoF() const
 {
-    return (Tell() >= mFileSize);
+    return (Tell64() >= mFileSize);
 }
 
 bool CFileInStream::IsValid() const
@@ -100,7 +167,7 @@ bool CFileInStream::IsValid() const
     return (mpFStream != 0);
 }
 
-uint32 CFileInStream::Size() const
+uint64 CFileInStream::Size64() const
 {
     return mFileSize;
 }
@@ -109,3 +176,23 @@ TString CFileInStream::FileName() const
 {
     return mName;
 }
+
+// ************ PRIVATE ************
+void CFileInStream::FillBuffer()
+{
+    // Only called once the window is exhausted, so the file is positioned right after the buffered data
+    ASSERT(mpReadCursor == mpReadLimit);
+    mBufferOffset += (mpReadLimit - mBuffer.data());
+
+    size_t NumRead = fread(mBuffer.data(), 1, skBufferSize, mpFStream);
+    mpReadCursor = mBuffer.data();
+    mpReadLimit = mpReadCursor + NumRead;
+}
+
+void CFileInStream::DiscardBuffer(uint64 FileOffset)
+{
+    // Empties the window; FileOffset must match the underlying file position
+    mBufferOffset = FileOffset;
+    mpReadCursor = mBuffer.data();
+    mpReadLimit = mpReadCursor;
+}
@@ -7,9 +7,17 @@
 class CFileInStream : public IInputStream
 {
 private:
+    // Reads are served from a buffer that's refilled in bulk; it backs the read window
+    static const uint32 skBufferSize = 0x10000;
+
     FILE *mpFStream;
     TString mName;
-    uint32 mFileSize;
+    uint64 mFileSize;
+    std::vector<uint8> mBuffer;
+    uint64 mBufferOffset; // File offset of the first byte in the buffer
+
+    void FillBuffer();
+    void DiscardBuffer(uint64 FileOffset);
 
 public:
     CFileInStream();
@@ -21,13 +29,11 @@ public:
     void Close();
 
     void ReadBytes(void *pDst, uint32 Count);
-    bool Seek(int32 Offset, uint32 Origin);
     bool Seek64(int64 Offset, uint32 Origin);
-    uint32 Tell() const;
     uint64 Tell64() const;
     bool EoF() const;
     bool IsValid() const;
-    uint32 Size() const;
+    uint64 Size64() const;
     TString FileName() const;
 };
 
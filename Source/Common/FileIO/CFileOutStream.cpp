@@ -1,30 +1,41 @@
 #include "CFileOutStream.h"
+#include "Common/Macros.h"
+
+#if !_WIN32
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
 
 CFileOutStream::CFileOutStream()
     : mpFStream(nullptr)
     , mSize(0)
+    , mPos(0)
+    , mFilePos(0)
+    , mBufferOffset(0)
+    , mBufferUsed(0)
 {
 }
 
 CFileOutStream::CFileOutStream(const TString& rkFile)
-    : mpFStream(nullptr)
+    : CFileOutStream()
 {
     Open(rkFile, EEndian::BigEndian);
 }
 
 CFileOutStream::CFileOutStream(const TString& rkFile, EEndian FileEndianness)
-    : mpFStream(nullptr)
+    : CFileOutStream()
 {
     Open(rkFile, FileEndianness);
 }
 
 CFileOutStream::CFileOutStream(const CFileOutStream& rkSrc)
-    : mpFStream(nullptr)
+    : CFileOutStream()
 {
     Open(rkSrc.mName, rkSrc.mDataEndianness);
 
     if (rkSrc.IsValid())
-        Seek(rkSrc.Tell(), SEEK_SET);
+        Seek64(rkSrc.Tell64(), SEEK_SET);
 }
 
 CFileOutStream::~CFileOutStream()
@@ -41,7 +52,12 @@ void CFileOutStream::Open(const TString& rkFile, EEndian FileEndianness)
     _wfopen_s(&mpFStream, ToWChar(rkFile), L"wb");
     mName = rkFile;
     mDataEndianness = FileEndianness;
-    mSize = 0;
+
+    // We do our own buffering, so stdio's would only add an extra copy
+    if (IsValid())
+        setvbuf(mpFStream, nullptr, _IONBF, 0);
+
+    InitBuffer(0);
 }
 
 void CFileOutStream::Update(const TString& rkFile, EEndian FileEndianness)
@@ -52,53 +68,169 @@ void CFileOutStream::Update(const TString& rkFile, EEndian FileEndianness)
     _wfopen_s(&mpFStream, ToWChar(rkFile), L"rb+");
     mName = rkFile;
     mDataEndianness = FileEndianness;
-    Seek(0x0, SEEK_END);
-    mSize = Tell();
-    Seek(0x0, SEEK_SET);
+
+    uint64 FileSize = 0;
+
+    if (IsValid())
+    {
+        // setvbuf has to come before any other operation on the stream, so it can't wait for InitBuffer
+        setvbuf(mpFStream, nullptr, _IONBF, 0);
+
+        _fseeki64(mpFStream, 0, SEEK_END);
+        FileSize = _ftelli64(mpFStream);
+        _fseeki64(mpFStream, 0, SEEK_SET);
+    }
+
+    InitBuffer(FileSize);
 }
 
 void CFileOutStream::Close()
 {
     if (IsValid())
+    {
+        Flush();
         fclose(mpFStream);
+    }
     mpFStream = nullptr;
     mSize = 0;
+    mPos = 0;
+}
+
+void CFileOutStream::Flush()
+{
+    if (!IsValid()) return;
+    FlushBuffer();
+    ApplyPatches();
+    fflush(mpFStream);
 }
 
 void CFileOutStream::WriteBytes(const void *pkSrc, uint32 Count)
 {
     if (!IsValid()) return;
-    fwrite(pkSrc, 1, Count, mpFStream);
-    if (Tell() > mSize) mSize = Tell();
+    const uint8 *pkData = (const uint8*) pkSrc;
+
+    while (Count > 0)
+    {
+        uint32 NumWritten;
+
+        // Before the buffered region; queue it as a patch
+        if (mPos < mBufferOffset)
+        {
+            uint64 BytesBeforeBuffer = mBufferOffset - mPos;
+            NumWritten = (Count < BytesBeforeBuffer ? Count : (uint32) BytesBeforeBuffer);
+            AddPatch(mPos, pkData, NumWritten);
+        }
+
+        // Inside or directly following the buffered region, with room left; write to the buffer
+        else if (mPos <= mBufferOffset + mBufferUsed && mPos - mBufferOffset < skBufferSize)
+        {
+            uint32 BufferPos = (uint32) (mPos - mBufferOffset);
+            uint32 BufferSpace = skBufferSize - BufferPos;
+            NumWritten = (Count < BufferSpace ? Count : BufferSpace);
+            memcpy(mBuffer.data() + BufferPos, pkData, NumWritten);
+
+            if (BufferPos + NumWritten > mBufferUsed)
+                mBufferUsed = BufferPos + NumWritten;
+        }
+
+        // Past the buffered region; write the buffer out and start a new one here
+        else
+        {
+            FlushBuffer();
+            mBufferOffset = mPos;
+
+            // Writes that wouldn't fit in the buffer anyway go straight to the file
+            if (Count < skBufferSize)
+                continue;
+
+            NumWritten = Count;
+            WriteToFile(mPos, pkData, NumWritten);
+            mBufferOffset = mPos + NumWritten;
+        }
+
+        pkData += NumWritten;
+        Count -= NumWritten;
+        mPos += NumWritten;
+    }
+
+    if (mPos > mSize) mSize = mPos;
 }
 
-bool CFileOutStream::Seek(int32 Offset, uint32 Origin)
+void CFileOutStream::WriteSegments(const SWriteSegment *pkSegments, uint32 NumSegments)
 {
-    if (!IsValid()) return false;
-    return (fseek(mpFStream, Offset, Origin) != 0);
+    if (!IsValid()) return;
+
+    uint64 TotalSize = 0;
+
+    for (uint32 SegIdx = 0; SegIdx < NumSegments; SegIdx++)
+        TotalSize += pkSegments[SegIdx].Size;
+
+    // Large batches that append to the buffered data go to the file in one gathered write along with
+    // the buffer contents, so big payloads are never copied into the buffer first. Anything else is
+    // cheaper to just buffer.
+    if (TotalSize < skBufferSize || mPos != mBufferOffset + mBufferUsed)
+    {
+        for (uint32 SegIdx = 0; SegIdx < NumSegments; SegIdx++)
+            WriteBytes(pkSegments[SegIdx].pkData, pkSegments[SegIdx].Size);
+
+        return;
+    }
+
+    std::vector<SWriteSegment> Segments;
+    Segments.reserve(NumSegments + 1);
+
+    if (mBufferUsed > 0)
+        Segments.push_back( SWriteSegment { mBuffer.data(), mBufferUsed } );
+
+    Segments.insert(Segments.end(), pkSegments, pkSegments + NumSegments);
+    WriteGathered(mBufferOffset, Segments.data(), (uint32) Segments.size());
+
+    mPos += TotalSize;
+    mBufferOffset = mPos;
+    mBufferUsed = 0;
+    if (mPos > mSize) mSize = mPos;
 }
 
 bool CFileOutStream::Seek64(int64 Offset, uint32 Origin)
 {
     if (!IsValid()) return false;
-    return (_fseeki64(mpFStream, Offset, Origin) != 0);
-}
+    int64 NewPos;
 
-uint32 CFileOutStream::Tell() const
-{
-    if (!IsValid()) return 0;
-    return ftell(mpFStream);
+    switch (Origin)
+    {
+        case SEEK_SET:
+            NewPos = Offset;
+            break;
+
+        case SEEK_CUR:
+            NewPos = (int64) mPos + Offset;
+            break;
+
+        case SEEK_END:
+            NewPos = (int64) mSize + Offset;
+            break;
+
+        default:
+            return false;
+    }
+
+    if (NewPos < 0)
+        return false;
+
+    // The file position isn't touched until we actually need to write something
+    mPos = (uint64) NewPos;
+    return true;
 }
 
 uint64 CFileOutStream::Tell64() const
 {
     if (!IsValid()) return 0;
-    return _ftelli64(mpFStream);
+    return mPos;
 }
 
 bool CFileOutStream::EoF() const
 {
-    return (Tell() == Size());
+    return (Tell64() == Size64());
 }
 
 bool CFileOutStream::IsValid() const
@@ -106,7 +238,7 @@ bool CFileOutStream::IsValid() const
     return (mpFStream != 0);
 }
 
-uint32 CFileOutStream::Size() const
+uint64 CFileOutStream::Size64() const
 {
     if (!IsValid()) return 0;
     return mSize;
@@ -116,3 +248,121 @@ TString CFileOutStream::FileName() const
 {
     return mName;
 }
+
+// ************ PRIVATE ************
+void CFileOutStream::InitBuffer(uint64 Size)
+{
+    mSize = Size;
+    mPos = 0;
+    mFilePos = 0;
+    mBufferOffset = 0;
+    mBufferUsed = 0;
+    mPatches.clear();
+    mPatchData.clear();
+
+    if (IsValid())
+        mBuffer.resize(skBufferSize);
+}
+
+void CFileOutStream::WriteToFile(uint64 Offset, const void *pkData, uint32 Count)
+{
+    // Only seek if the file handle isn't already where we need it
+    if (mFilePos != Offset)
+        _fseeki64(mpFStream, Offset, SEEK_SET);
+
+    fwrite(pkData, 1, Count, mpFStream);
+    mFilePos = Offset + Count;
+}
+
+void CFileOutStream::WriteGathered(uint64 Offset, const SWriteSegment *pkSegments, uint32 NumSegments)
+{
+#if _WIN32
+    // WriteFileGather only works on unbuffered, page-aligned I/O, so write the segments back-to-back instead
+    for (uint32 SegIdx = 0; SegIdx < NumSegments; SegIdx++)
+    {
+        WriteToFile(Offset, pkSegments[SegIdx].pkData, pkSegments[SegIdx].Size);
+        Offset += pkSegments[SegIdx].Size;
+    }
+#else
+    // pwritev doesn't move the file position, so mFilePos stays accurate
+    int FileDesc = fileno(mpFStream);
+    std::vector<iovec> IOVecs(NumSegments);
+
+    for (uint32 SegIdx = 0; SegIdx < NumSegments; SegIdx++)
+    {
+        IOVecs[SegIdx].iov_base = (void*) pkSegments[SegIdx].pkData;
+        IOVecs[SegIdx].iov_len = pkSegments[SegIdx].Size;
+    }
+
+    iovec *pVec = IOVecs.data();
+    iovec *pVecEnd = pVec + IOVecs.size();
+
+    while (pVec < pVecEnd)
+    {
+        int NumVecs = (int) (pVecEnd - pVec);
+        if (NumVecs > IOV_MAX) NumVecs = IOV_MAX;
+
+        ssize_t NumWritten = pwritev(FileDesc, pVec, NumVecs, (off_t) Offset);
+
+        if (NumWritten < 0)
+        {
+            errorf("Failed to write to file: %s", *mName);
+            return;
+        }
+
+        // Skip past whatever was written; a short write can leave us partway through a segment
+        Offset += NumWritten;
+
+        while (pVec < pVecEnd && (size_t) NumWritten >= pVec->iov_len)
+        {
+            NumWritten -= pVec->iov_len;
+            pVec++;
+        }
+
+        if (pVec < pVecEnd)
+        {
+            pVec->iov_base = (uint8*) pVec->iov_base + NumWritten;
+            pVec->iov_len -= NumWritten;
+        }
+    }
+#endif
+}
+
+void CFileOutStream::FlushBuffer()
+{
+    if (mBufferUsed > 0)
+    {
+        WriteToFile(mBufferOffset, mBuffer.data(), mBufferUsed);
+        mBufferOffset += mBufferUsed;
+        mBufferUsed = 0;
+    }
+}
+
+void CFileOutStream::AddPatch(uint64 Offset, const void *pkData, uint32 Count)
+{
+    // Merge with the previous patch if this one directly follows it, which is the common case for
+    // consecutive backpatched fields
+    if (!mPatches.empty() && mPatches.back().Offset + mPatches.back().Size == Offset)
+        mPatches.back().Size += Count;
+    else
+        mPatches.push_back( SPatch { Offset, (uint32) mPatchData.size(), Count } );
+
+    mPatchData.insert(mPatchData.end(), (const uint8*) pkData, (const uint8*) pkData + Count);
+
+    if (mPatchData.size() >= skBufferSize)
+        ApplyPatches();
+}
+
+void CFileOutStream::ApplyPatches()
+{
+    // Patches only ever cover data that's already been written, so they can be applied in order
+    // without flushing the buffer first
+    for (uint32 PatchIdx = 0; PatchIdx < mPatches.size(); PatchIdx++)
+    {
+        const SPatch& rkPatch = mPatches[PatchIdx];
+        WriteToFile(rkPatch.Offset, mPatchData.data() + rkPatch.DataStart, rkPatch.Size);
+    }
+
+    mPatches.clear();
+    mPatchData.clear();
+}
@@ -2,13 +2,44 @@
 #define CFILEOUTSTREAM_H
 
 #include "IOutputStream.h"
+#include <vector>
 
 class CFileOutStream : public IOutputStream
 {
 private:
+    /**
+     * Writes go to a large write-behind buffer covering a contiguous region of the file, and
+     * are only written out when the buffer fills up or the stream is flushed. Seeking is free;
+     * writes that land inside the buffered region (like size backpatches) just overwrite the
+     * buffer, and writes that land before it are queued in a patch list that's applied in one
+     * pass on flush. Neither touches the file until then.
+     */
+    static const uint32 skBufferSize = 0x100000;
+
+    struct SPatch
+    {
+        uint64 Offset;
+        uint32 DataStart;
+        uint32 Size;
+    };
+
     FILE *mpFStream;
     TString mName;
-    uint32 mSize;
+    uint64 mSize;
+    uint64 mPos;
+    uint64 mFilePos; // Current position of the underlying file handle
+    std::vector<uint8> mBuffer;
+    uint64 mBufferOffset;
+    uint32 mBufferUsed;
+    std::vector<SPatch> mPatches;
+    std::vector<uint8> mPatchData;
+
+    void InitBuffer(uint64 Size);
+    void WriteToFile(uint64 Offset, const void *pkData, uint32 Count);
+    void WriteGathered(uint64 Offset, const SWriteSegment *pkSegments, uint32 NumSegments);
+    void FlushBuffer();
+    void AddPatch(uint64 Offset, const void *pkData, uint32 Count);
+    void ApplyPatches();
 
 public:
     CFileOutStream();
@@ -19,15 +50,15 @@ public:
     void Open(const TString& rkFile, EEndian);
     void Update(const TString& rkFile, EEndian FileEndianness);
     void Close();
+    void Flush();
 
     void WriteBytes(const void *pkSrc, uint32 Count);
-    bool Seek(int32 Offset, uint32 Origin);
+    void WriteSegments(const SWriteSegment *pkSegments, uint32 NumSegments);
     bool Seek64(int64 Offset, uint32 Origin);
-    uint32 Tell() const;
     uint64 Tell64() const;
     bool EoF() const;
     bool IsValid() const;
-    uint32 Size() const;
+    uint64 Size64() const;
     TString FileName() const;
 };
 
@@ -0,0 +1,259 @@
+#include "CMappedFileInStream.h"
+
+#if _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+CMappedFileInStream::CMappedFileInStream()
+    : mpData(nullptr)
+    , mFileSize(0)
+    , mIsOpen(false)
+#if _WIN32
+    , mpFileHandle(nullptr)
+    , mpMappingHandle(nullptr)
+#endif
+{
+}
+
+CMappedFileInStream::CMappedFileInStream(const TString& rkFile)
+    : CMappedFileInStream()
+{
+    Open(rkFile, EEndian::BigEndian);
+}
+
+CMappedFileInStream::CMappedFileInStream(const TString& rkFile, EEndian FileEndianness)
+    : CMappedFileInStream()
+{
+    Open(rkFile, FileEndianness);
+}
+
+CMappedFileInStream::CMappedFileInStream(const CMappedFileInStream& rkSrc)
+    : CMappedFileInStream()
+{
+    Open(rkSrc.mName, rkSrc.mDataEndianness);
+
+    if (rkSrc.IsValid())
+        Seek64(rkSrc.Tell64(), SEEK_SET);
+}
+
+CMappedFileInStream::~CMappedFileInStream()
+{
+    if (IsValid())
+        Close();
+}
+
+void CMappedFileInStream::Open(const TString& rkFile, EEndian FileEndianness)
+{
+    if (IsValid())
+        Close();
+
+    mName = rkFile;
+    mDataEndianness = FileEndianness;
+    SetSourceString(rkFile.GetFileName());
+
+#if _WIN32
+    HANDLE File = CreateFileW(ToWChar(rkFile), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (File == INVALID_HANDLE_VALUE) return;
+
+    LARGE_INTEGER FileSize;
+    if (!GetFileSizeEx(File, &FileSize))
+    {
+        CloseHandle(File);
+        return;
+    }
+
+    mpFileHandle = File;
+    mFileSize = (uint64) FileSize.QuadPart;
+    mIsOpen = true;
+
+    // Zero-length files can't be mapped; they're still valid streams, just empty ones.
+    if (mFileSize > 0)
+    {
+        mpMappingHandle = CreateFileMappingW(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        if (mpMappingHandle)
+            mpData = (const char*) MapViewOfFile(mpMappingHandle, FILE_MAP_READ, 0, 0, 0);
+
+        if (!mpData)
+        {
+            errorf("Failed to map file into memory: %s", *rkFile);
+            Close();
+            return;
+        }
+
+        mpReadCursor = (const uint8*) mpData;
+        mpReadLimit = mpReadCursor + mFileSize;
+    }
+#else
+    int File = open(*rkFile, O_RDONLY);
+    if (File < 0) return;
+
+    struct stat FileStat;
+    if (fstat(File, &FileStat) != 0)
+    {
+        close(File);
+        return;
+    }
+
+    mFileSize = (uint64) FileStat.st_size;
+    mIsOpen = true;
+
+    // Zero-length files can't be mapped; they're still valid streams, just empty ones.
+    if (mFileSize > 0)
+    {
+        void *pMapping = mmap(nullptr, mFileSize, PROT_READ, MAP_PRIVATE, File, 0);
+
+        if (pMapping != MAP_FAILED)
+        {
+            madvise(pMapping, mFileSize, MADV_SEQUENTIAL);
+            mpData = (const char*) pMapping;
+            mpReadCursor = (const uint8*) mpData;
+            mpReadLimit = mpReadCursor + mFileSize;
+        }
+        else
+        {
+            errorf("Failed to map file into memory: %s", *rkFile);
+            mIsOpen = false;
+            mFileSize = 0;
+        }
+    }
+
+    // The mapping holds its own reference to the file, so the descriptor isn't needed anymore
+    close(File);
+#endif
+}
+
+void CMappedFileInStream::Close()
+{
+#if _WIN32
+    if (mpData)
+        UnmapViewOfFile(mpData);
+    if (mpMappingHandle)
+        CloseHandle((HANDLE) mpMappingHandle);
+    if (mpFileHandle)
+        CloseHandle((HANDLE) mpFileHandle);
+
+    mpMappingHandle = nullptr;
+    mpFileHandle = nullptr;
+#else
+    if (mpData)
+        munmap((void*) mpData, mFileSize);
+#endif
+
+    mpData = nullptr;
+    mpReadCursor = nullptr;
+    mpReadLimit = nullptr;
+    mFileSize = 0;
+    mIsOpen = false;
+}
+
+void CMappedFileInStream::ReadBytes(void *pDst, uint32 Count)
+{
+    if (!IsValid()) return;
+
+    uint64 Remaining = (uint64) (mpReadLimit - mpReadCursor);
+    if (Count > Remaining) Count = (uint32) Remaining;
+
+    memcpy(pDst, mpReadCursor, Count);
+    mpReadCursor += Count;
+}
+
+const void* CMappedFileInStream::ReadSpan(uint32 Count)
+{
+    // Returns a pointer directly into the mapping and advances past it. Fails if there aren't Count bytes left.
+    if (!IsValid() || Count > (uint64) (mpReadLimit - mpReadCursor))
+        return nullptr;
+
+    const void *pkSpan = mpReadCursor;
+    mpReadCursor += Count;
+    return pkSpan;
+}
+
+bool CMappedFileInStream::Seek64(int64 Offset, uint32 Origin)
+{
+    if (!IsValid()) return false;
+    int64 NewPos;
+
+    switch (Origin)
+    {
+        case SEEK_SET:
+            NewPos = Offset;
+            break;
+
+        case SEEK_CUR:
+            NewPos = (int64) Tell64() + Offset;
+            break;
+
+        case SEEK_END:
+            NewPos = (int64) mFileSize - Offset;
+            break;
+
+        default:
+            return false;
+    }
+
+    bool Success = true;
+
+    if (NewPos < 0)
+    {
+        NewPos = 0;
+        Success = false;
+    }
+
+    if (NewPos > (int64) mFileSize)
+    {
+        NewPos = mFileSize;
+        Success = false;
+    }
+
+    mpReadCursor = (const uint8*) mpData + NewPos;
+    return Success;
+}
+
+uint64 CMappedFileInStream::Tell64() const
+{
+    return (uint64) (mpReadCursor - (const uint8*) mpData);
+}
+
+bool CMappedFileInStream::EoF() const
+{
+    return (mpReadCursor >= mpReadLimit);
+}
+
+bool CMappedFileInStream::IsValid() const
+{
+    return mIsOpen;
+}
+
+uint64 CMappedFileInStream::Size64() const
+{
+    return mFileSize;
+}
+
+bool CMappedFileInStream::IsMemoryBacked() const
+{
+    return true;
+}
+
+TString CMappedFileInStream::FileName() const
+{
+    return mName;
+}
+
+const void* CMappedFileInStream::Data() const
+{
+    return mpData;
+}
+
+const void* CMappedFileInStream::DataAtPosition() const
+{
+    return mpReadCursor;
+}
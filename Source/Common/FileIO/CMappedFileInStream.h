@@ -0,0 +1,48 @@
+#ifndef CMAPPEDFILEINSTREAM_H
+#define CMAPPEDFILEINSTREAM_H
+
+#include "IInputStream.h"
+
+/**
+ * Input stream that maps an entire file into memory read-only. Reads are plain memcpys
+ * out of the mapping with no per-call syscall or stdio lock, and ReadSpan() hands out
+ * pointers directly into the mapping without copying at all. Returned spans remain valid
+ * until the stream is closed.
+ */
+class CMappedFileInStream : public IInputStream
+{
+private:
+    // The read window always spans from the current position to the end of the mapping
+    const char *mpData;
+    uint64 mFileSize;
+    bool mIsOpen;
+    TString mName;
+
+#if _WIN32
+    void *mpFileHandle;
+    void *mpMappingHandle;
+#endif
+
+public:
+    CMappedFileInStream();
+    CMappedFileInStream(const TString& rkFile);
+    CMappedFileInStream(const TString& rkFile, EEndian FileEndianness);
+    CMappedFileInStream(const CMappedFileInStream& rkSrc);
+    ~CMappedFileInStream();
+    void Open(const TString& rkFile, EEndian FileEndianness);
+    void Close();
+
+    void ReadBytes(void *pDst, uint32 Count);
+    const void* ReadSpan(uint32 Count);
+    bool Seek64(int64 Offset, uint32 Origin);
+    uint64 Tell64() const;
+    bool EoF() const;
+    bool IsValid() const;
+    uint64 Size64() const;
+    bool IsMemoryBacked() const;
+    TString FileName() const;
+    const void* Data() const;
+    const void* DataAtPosition() const;
+};
+
+#endif // CMAPPEDFILEINSTREAM_H
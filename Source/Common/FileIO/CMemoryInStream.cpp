@@ -3,10 +3,9 @@
 CMemoryInStream::CMemoryInStream()
     : mpDataStart(nullptr)
     , mDataSize(0)
-    , mPos(0)
 {
 }
-CMemoryInStream::CMemoryInStream(const void *pkData, uint32 Size, EEndian DataEndianness)
+CMemoryInStream::CMemoryInStream(const void *pkData, uint64 Size, EEndian DataEndianness)
 {
     SetData(pkData, Size, DataEndianness);
 }
@@ -15,65 +14,86 @@ CMemoryInStream::~CMemoryInStream()
 {
 }
 
-void CMemoryInStream::SetData(const void *pkData, uint32 Size, EEndian DataEndianness)
+void CMemoryInStream::SetData(const void *pkData, uint64 Size, EEndian DataEndianness)
 {
     mpDataStart = (const char*) pkData;
     mDataSize = Size;
-    mPos = 0;
+    mpReadCursor = (const uint8*) mpDataStart;
+    mpReadLimit = mpReadCursor + mDataSize;
     mDataEndianness = DataEndianness;
 }
 
 void CMemoryInStream::ReadBytes(void *pDst, uint32 Count)
 {
     if (!IsValid()) return;
-    memcpy(pDst, mpDataStart + mPos, Count);
-    mPos += Count;
+
+    uint64 Remaining = (uint64) (mpReadLimit - mpReadCursor);
+    if (Count > Remaining) Count = (uint32) Remaining;
+
+    memcpy(pDst, mpReadCursor, Count);
+    mpReadCursor += Count;
 }
 
-bool CMemoryInStream::Seek(int32 Offset, uint32 Origin)
+const void* CMemoryInStream::ReadSpan(uint32 Count)
+{
+    // Returns a pointer directly into the buffer and advances past it. Fails if there aren't Count bytes left.
+    if (!IsValid() || Count > (uint64) (mpReadLimit - mpReadCursor))
+        return nullptr;
+
+    const void *pkSpan = mpReadCursor;
+    mpReadCursor += Count;
+    return pkSpan;
+}
+
+bool CMemoryInStream::Seek64(int64 Offset, uint32 Origin)
 {
     if (!IsValid()) return false;
+    int64 NewPos;
+
     switch (Origin)
     {
         case SEEK_SET:
-            mPos = Offset;
+            NewPos = Offset;
             break;
 
         case SEEK_CUR:
-            mPos += Offset;
+            NewPos = (int64) Tell64() + Offset;
             break;
 
         case SEEK_END:
-            mPos = mDataSize - Offset;
+            NewPos = (int64) mDataSize - Offset;
             break;
 
         default:
             return false;
     }
 
-    if (mPos < 0)
+    bool Success = true;
+
+    if (NewPos < 0)
     {
-        mPos = 0;
-        return false;
+        NewPos = 0;
+        Success = false;
     }
 
-    if (mPos > mDataSize)
+    if (NewPos > (int64) mDataSize)
     {
-        mPos = mDataSize;
-        return false;
+        NewPos = mDataSize;
+        Success = false;
     }
 
-    return true;
+    mpReadCursor = (const uint8*) mpDataStart + NewPos;
+    return Success;
 }
 
-uint32 CMemoryInStream::Tell() const
+uint64 CMemoryInStream::Tell64() const
 {
-    return mPos;
+    return (uint64) (mpReadCursor - (const uint8*) mpDataStart);
 }
 
 bool CMemoryInStream::EoF() const
 {
-    return (mPos >= mDataSize);
+    return (mpReadCursor >= mpReadLimit);
 }
 
 bool CMemoryInStream::IsValid() const
@@ -81,16 +101,23 @@ bool CMemoryInStream::IsValid() const
     return (mpDataStart != nullptr);
 }
 
-uint32 CMemoryInStream::Size() const
+uint64 CMemoryInStream::Size64() const
 {
     return mDataSize;
 }
 
-void CMemoryInStream::SetSize(uint32 Size)
+bool CMemoryInStream::IsMemoryBacked() const
+{
+    return true;
+}
+
+void CMemoryInStream::SetSize(uint64 Size)
 {
     mDataSize = Size;
-    if (mPos > mDataSize)
-        mPos = mDataSize;
+    mpReadLimit = (const uint8*) mpDataStart + mDataSize;
+
+    if (mpReadCursor > mpReadLimit)
+        mpReadCursor = mpReadLimit;
 }
 
 const void* CMemoryInStream::Data() const
@@ -100,5 +127,5 @@ const void* CMemoryInStream::Data() const
 
 const void* CMemoryInStream::DataAtPosition() const
 {
-    return mpDataStart + mPos;
+    return mpReadCursor;
 }
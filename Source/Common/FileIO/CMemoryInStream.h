@@ -5,23 +5,25 @@
 
 class CMemoryInStream : public IInputStream
 {
+    // The read window always spans from the current position to the end of the buffer
     const char *mpDataStart;
-    uint32 mDataSize;
-    uint32 mPos;
+    uint64 mDataSize;
 
 public:
     CMemoryInStream();
-    CMemoryInStream(const void *pkData, uint32 Size, EEndian dataEndianness);
+    CMemoryInStream(const void *pkData, uint64 Size, EEndian dataEndianness);
     ~CMemoryInStream();
-    void SetData(const void *pkData, uint32 Size, EEndian dataEndianness);
+    void SetData(const void *pkData, uint64 Size, EEndian dataEndianness);
 
     void ReadBytes(void *pDst, uint32 Count);
-    bool Seek(int32 Offset, uint32 Origin);
-    uint32 Tell() const;
+    const void* ReadSpan(uint32 Count);
+    bool Seek64(int64 Offset, uint32 Origin);
+    uint64 Tell64() const;
     bool EoF() const;
     bool IsValid() const;
-    uint32 Size() const;
-    void SetSize(uint32 Size);
+    uint64 Size64() const;
+    bool IsMemoryBacked() const;
+    void SetSize(uint64 Size);
     const void* Data() const;
     const void* DataAtPosition() const;
 };
@@ -8,7 +8,7 @@ CMemoryOutStream::CMemoryOutStream()
 {
 }
 
-CMemoryOutStream::CMemoryOutStream(void *pData, uint32 Size, EEndian DataEndianness)
+CMemoryOutStream::CMemoryOutStream(void *pData, uint64 Size, EEndian DataEndianness)
 {
     SetData(pData, Size, DataEndianness);
 }
@@ -17,7 +17,7 @@ CMemoryOutStream::~CMemoryOutStream()
 {
 }
 
-void CMemoryOutStream::SetData(void *pData, uint32 Size, EEndian DataEndianness)
+void CMemoryOutStream::SetData(void *pData, uint64 Size, EEndian DataEndianness)
 {
     mpDataStart = (char*) pData;
     mDataSize = Size;
@@ -35,44 +35,46 @@ void CMemoryOutStream::WriteBytes(const void *pkSrc, uint32 Count)
     if (mPos > mUsed) mUsed = mPos;
 }
 
-bool CMemoryOutStream::Seek(int32 Offset, uint32 Origin)
+bool CMemoryOutStream::Seek64(int64 Offset, uint32 Origin)
 {
     if (!IsValid()) return false;
+    int64 NewPos;
 
     switch (Origin)
     {
         case SEEK_SET:
-            mPos = Offset;
+            NewPos = Offset;
             break;
 
         case SEEK_CUR:
-            mPos += Offset;
+            NewPos = (int64) mPos + Offset;
             break;
 
         case SEEK_END:
-            mPos = mDataSize - Offset;
+            NewPos = (int64) mDataSize - Offset;
             break;
 
         default:
             return false;
     }
 
-    if (mPos < 0)
+    if (NewPos < 0)
     {
         mPos = 0;
         return false;
     }
 
-    if (mPos > mDataSize)
+    if (NewPos > (int64) mDataSize)
     {
         mPos = mDataSize;
         return false;
     }
 
+    mPos = (uint64) NewPos;
     return true;
 }
 
-uint32 CMemoryOutStream::Tell() const
+uint64 CMemoryOutStream::Tell64() const
 {
     return mPos;
 }
@@ -87,17 +89,17 @@ bool CMemoryOutStream::IsValid() const
     return (mpDataStart != nullptr);
 }
 
-uint32 CMemoryOutStream::Size() const
+uint64 CMemoryOutStream::Size64() const
 {
     return mDataSize;
 }
 
-uint32 CMemoryOutStream::SpaceUsed() const
+uint64 CMemoryOutStream::SpaceUsed() const
 {
     return mUsed;
 }
 
-void CMemoryOutStream::SetSize(uint32 Size)
+void CMemoryOutStream::SetSize(uint64 Size)
 {
     mDataSize = Size;
     if (mPos > mDataSize)
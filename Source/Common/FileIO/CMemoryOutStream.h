@@ -6,24 +6,24 @@
 class CMemoryOutStream : public IOutputStream
 {
     char *mpDataStart;
-    uint32 mDataSize;
-    uint32 mPos;
-    uint32 mUsed;
+    uint64 mDataSize;
+    uint64 mPos;
+    uint64 mUsed;
 
 public:
     CMemoryOutStream();
-    CMemoryOutStream(void *pData, uint32 Size, EEndian mDataEndianness);
+    CMemoryOutStream(void *pData, uint64 Size, EEndian mDataEndianness);
     ~CMemoryOutStream();
-    void SetData(void *pData, uint32 Size, EEndian mDataEndianness);
+    void SetData(void *pData, uint64 Size, EEndian mDataEndianness);
 
     void WriteBytes(const void *pkSrc, uint32 Count);
-    bool Seek(int32 Offset, uint32 Origin);
-    uint32 Tell() const;
+    bool Seek64(int64 Offset, uint32 Origin);
+    uint64 Tell64() const;
     bool EoF() const;
     bool IsValid() const;
-    uint32 Size() const;
-    uint32 SpaceUsed() const;
-    void SetSize(uint32 Size);
+    uint64 Size64() const;
+    uint64 SpaceUsed() const;
+    void SetSize(uint64 Size);
     void* Data() const;
     void* DataAtPosition() const;
 };
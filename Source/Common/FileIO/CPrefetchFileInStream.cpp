@@ -0,0 +1,303 @@
+#include "CPrefetchFileInStream.h"
+#include "Common/Macros.h"
+
+CPrefetchFileInStream::CPrefetchFileInStream()
+    : mpFStream(nullptr)
+    , mFileSize(0)
+    , mHasCurrentBlock(false)
+    , mpWindowStart(nullptr)
+    , mWindowOffset(0)
+    , mHead(0)
+    , mNumFilled(0)
+    , mPrefetchOffset(0)
+    , mGeneration(0)
+    , mStopThread(false)
+{
+}
+
+CPrefetchFileInStream::CPrefetchFileInStream(const TString& rkFile)
+    : CPrefetchFileInStream()
+{
+    Open(rkFile, EEndian::BigEndian);
+}
+
+CPrefetchFileInStream::CPrefetchFileInStream(const TString& rkFile, EEndian FileEndianness)
+    : CPrefetchFileInStream()
+{
+    Open(rkFile, FileEndianness);
+}
+
+CPrefetchFileInStream::CPrefetchFileInStream(const CPrefetchFileInStream& rkSrc)
+    : CPrefetchFileInStream()
+{
+    Open(rkSrc.mName, rkSrc.mDataEndianness);
+
+    if (rkSrc.IsValid())
+        Seek64(rkSrc.Tell64(), SEEK_SET);
+}
+
+CPrefetchFileInStream::~CPrefetchFileInStream()
+{
+    if (IsValid())
+        Close();
+}
+
+void CPrefetchFileInStream::Open(const TString& rkFile, EEndian FileEndianness)
+{
+    if (IsValid())
+        Close();
+
+    _wfopen_s(&mpFStream, ToWChar(rkFile), L"rb");
+    mName = rkFile;
+    mDataEndianness = FileEndianness;
+    SetSourceString(rkFile.GetFileName());
+
+    if (IsValid())
+    {
+        // The I/O thread reads whole blocks at a time, so stdio's buffer would only add an extra copy.
+        // setvbuf has to come before any other operation on the stream.
+        setvbuf(mpFStream, nullptr, _IONBF, 0);
+
+        _fseeki64(mpFStream, 0, SEEK_END);
+        mFileSize = (uint64) _ftelli64(mpFStream);
+        _fseeki64(mpFStream, 0, SEEK_SET);
+
+        for (uint32 BlockIdx = 0; BlockIdx < skNumBlocks; BlockIdx++)
+            mBlocks[BlockIdx].Data.resize(skBlockSize);
+
+        mStopThread = false;
+        Retarget(0);
+        mThread = std::thread(&CPrefetchFileInStream::PrefetchThread, this);
+    }
+    else
+        mFileSize = 0;
+}
+
+void CPrefetchFileInStream::Close()
+{
+    if (mThread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> Lock(mMutex);
+            mStopThread = true;
+        }
+
+        mWakeWorker.notify_one();
+        mThread.join();
+    }
+
+    if (IsValid())
+        fclose(mpFStream);
+
+    mpFStream = nullptr;
+    mFileSize = 0;
+    Retarget(0);
+}
+
+void CPrefetchFileInStream::ReadBytes(void *pDst, uint32 Count)
+{
+    if (!IsValid()) return;
+    uint8 *pOut = (uint8*) pDst;
+
+    while (Count > 0)
+    {
+        uint32 Buffered = (uint32) (mpReadLimit - mpReadCursor);
+
+        if (Buffered > 0)
+        {
+            uint32 CopySize = (Count < Buffered ? Count : Buffered);
+            memcpy(pOut, mpReadCursor, CopySize);
+            mpReadCursor += CopySize;
+            pOut += CopySize;
+            Count -= CopySize;
+        }
+
+        else if (!NextBlock())
+            break;
+    }
+}
+
+bool CPrefetchFileInStream::Seek64(int64 Offset, uint32 Origin)
+{
+    if (!IsValid()) return false;
+    int64 NewPos;
+
+    switch (Origin)
+    {
+        case SEEK_SET:
+            NewPos = Offset;
+            break;
+
+        case SEEK_CUR:
+            NewPos = (int64) Tell64() + Offset;
+            break;
+
+        case SEEK_END:
+            NewPos = (int64) mFileSize + Offset;
+            break;
+
+        default:
+            return false;
+    }
+
+    if (NewPos < 0)
+        return false;
+
+    // Seeks that land inside the current block just move the cursor
+    uint64 WindowEnd = mWindowOffset + (mpReadLimit - mpWindowStart);
+
+    if ((uint64) NewPos >= mWindowOffset && (uint64) NewPos <= WindowEnd)
+    {
+        mpReadCursor = mpWindowStart + (NewPos - mWindowOffset);
+        return true;
+    }
+
+    std::lock_guard<std::mutex> Lock(mMutex);
+
+    // If the target has already been prefetched, skip ahead to its block
+    for (uint32 FillIdx = 0; FillIdx < mNumFilled; FillIdx++)
+    {
+        const SBlock& rkBlock = mBlocks[(mHead + FillIdx) % skNumBlocks];
+
+        if ((uint64) NewPos >= rkBlock.Offset && (uint64) NewPos < rkBlock.Offset + rkBlock.Size)
+        {
+            PopBlocks(FillIdx);
+            UseHeadBlock();
+            mpReadCursor = mpWindowStart + (NewPos - mWindowOffset);
+            return true;
+        }
+    }
+
+    Retarget(NewPos);
+    return true;
+}
+
+uint64 CPrefetchFileInStream::Tell64() const
+{
+    if (!IsValid()) return 0;
+    return mWindowOffset + (mpReadCursor - mpWindowStart);
+}
+
+bool CPrefetchFileInStream::EoF() const
+{
+    return (Tell64() >= mFileSize);
+}
+
+bool CPrefetchFileInStream::IsValid() const
+{
+    return (mpFStream != 0);
+}
+
+uint64 CPrefetchFileInStream::Size64() const
+{
+    return mFileSize;
+}
+
+TString CPrefetchFileInStream::FileName() const
+{
+    return mName;
+}
+
+// ************ PRIVATE ************
+void CPrefetchFileInStream::PrefetchThread()
+{
+    // The I/O thread owns the file handle for as long as it's running
+    uint64 FilePos = 0;
+    std::unique_lock<std::mutex> Lock(mMutex);
+
+    while (true)
+    {
+        mWakeWorker.wait(Lock, [this] {
+            return mStopThread || (mNumFilled < skNumBlocks && mPrefetchOffset < mFileSize);
+        });
+
+        if (mStopThread)
+            break;
+
+        // Claim the first free block in the ring. The consumer never touches unfilled blocks,
+        // so it's safe to read into it without holding the lock.
+        SBlock& rBlock = mBlocks[(mHead + mNumFilled) % skNumBlocks];
+        uint64 Offset = mPrefetchOffset;
+        uint32 Generation = mGeneration;
+        Lock.unlock();
+
+        if (FilePos != Offset)
+            _fseeki64(mpFStream, Offset, SEEK_SET);
+
+        uint32 NumRead = (uint32) fread(rBlock.Data.data(), 1, skBlockSize, mpFStream);
+        FilePos = Offset + NumRead;
+
+        Lock.lock();
+
+        // If the consumer seeked away while we were reading, the data is stale
+        if (Generation == mGeneration)
+        {
+            rBlock.Offset = Offset;
+            rBlock.Size = NumRead;
+            mNumFilled++;
+
+            // A failed read ends prefetching rather than retrying the same offset forever
+            mPrefetchOffset = (NumRead > 0 ? Offset + NumRead : mFileSize);
+            mBlockReady.notify_one();
+        }
+    }
+}
+
+bool CPrefetchFileInStream::NextBlock()
+{
+    // Hands the exhausted block back to the I/O thread and waits for the next one
+    std::unique_lock<std::mutex> Lock(mMutex);
+
+    if (mHasCurrentBlock)
+        PopBlocks(1);
+
+    mBlockReady.wait(Lock, [this] { return mNumFilled > 0 || mPrefetchOffset >= mFileSize; });
+
+    if (mNumFilled == 0)
+        return false;
+
+    UseHeadBlock();
+    return true;
+}
+
+void CPrefetchFileInStream::PopBlocks(uint32 Count)
+{
+    // Must be called with the lock held. Moves the position to the end of the last popped block.
+    if (Count == 0) return;
+    const SBlock& rkLast = mBlocks[(mHead + Count - 1) % skNumBlocks];
+    mWindowOffset = rkLast.Offset + rkLast.Size;
+
+    mHead = (mHead + Count) % skNumBlocks;
+    mNumFilled -= Count;
+    mHasCurrentBlock = false;
+    mpWindowStart = nullptr;
+    mpReadCursor = nullptr;
+    mpReadLimit = nullptr;
+    mWakeWorker.notify_one();
+}
+
+void CPrefetchFileInStream::UseHeadBlock()
+{
+    // Must be called with the lock held and at least one filled block
+    ASSERT(mNumFilled > 0);
+    const SBlock& rkBlock = mBlocks[mHead];
+    mHasCurrentBlock = true;
+    mWindowOffset = rkBlock.Offset;
+    mpWindowStart = rkBlock.Data.data();
+    mpReadCursor = mpWindowStart;
+    mpReadLimit = mpWindowStart + rkBlock.Size;
+}
+
+void CPrefetchFileInStream::Retarget(uint64 Offset)
+{
+    // Must be called with the lock held, or while the I/O thread isn't running. Discards the ring.
+    mGeneration++;
+    mNumFilled = 0;
+    mPrefetchOffset = Offset;
+    mHasCurrentBlock = false;
+    mWindowOffset = Offset;
+    mpWindowStart = nullptr;
+    mpReadCursor = nullptr;
+    mpReadLimit = nullptr;
+    mWakeWorker.notify_one();
+}
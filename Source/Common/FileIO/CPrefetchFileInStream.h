@@ -0,0 +1,74 @@
+#ifndef CPREFETCHFILEINSTREAM_H
+#define CPREFETCHFILEINSTREAM_H
+
+#include "IInputStream.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/**
+ * File input stream that reads ahead on a dedicated I/O thread. The thread fills a ring of
+ * fixed-size blocks ahead of the current position while the consumer parses the block it's
+ * currently on, so parsing overlaps with I/O. The current block backs the read window.
+ * Seeking within the current block or to a block that has already been prefetched is cheap;
+ * seeking anywhere else discards the ring and restarts prefetching at the new position.
+ */
+class CPrefetchFileInStream : public IInputStream
+{
+private:
+    static const uint32 skBlockSize = 0x40000;
+    static const uint32 skNumBlocks = 8;
+
+    struct SBlock
+    {
+        std::vector<uint8> Data;
+        uint64 Offset;
+        uint32 Size;
+    };
+
+    FILE *mpFStream;
+    TString mName;
+    uint64 mFileSize;
+
+    // Consumer state
+    bool mHasCurrentBlock;      // Whether the head block is the one backing the read window
+    const uint8 *mpWindowStart;
+    uint64 mWindowOffset;       // File offset of mpWindowStart; the current position if there's no window
+
+    // Ring state shared with the I/O thread; guarded by mMutex
+    std::thread mThread;
+    std::mutex mMutex;
+    std::condition_variable mBlockReady;
+    std::condition_variable mWakeWorker;
+    SBlock mBlocks[skNumBlocks];
+    uint32 mHead;
+    uint32 mNumFilled;          // Number of filled blocks starting at mHead, including the current block
+    uint64 mPrefetchOffset;     // File offset the next block will be read from
+    uint32 mGeneration;         // Bumped when the ring is discarded so in-flight reads get dropped
+    bool mStopThread;
+
+    void PrefetchThread();
+    bool NextBlock();
+    void PopBlocks(uint32 Count);
+    void UseHeadBlock();
+    void Retarget(uint64 Offset);
+
+public:
+    CPrefetchFileInStream();
+    CPrefetchFileInStream(const TString& rkFile);
+    CPrefetchFileInStream(const TString& rkFile, EEndian FileEndianness);
+    CPrefetchFileInStream(const CPrefetchFileInStream& rkSrc);
+    ~CPrefetchFileInStream();
+    void Open(const TString& rkFile, EEndian FileEndianness);
+    void Close();
+
+    void ReadBytes(void *pDst, uint32 Count);
+    bool Seek64(int64 Offset, uint32 Origin);
+    uint64 Tell64() const;
+    bool EoF() const;
+    bool IsValid() const;
+    uint64 Size64() const;
+    TString FileName() const;
+};
+
+#endif // CPREFETCHFILEINSTREAM_H
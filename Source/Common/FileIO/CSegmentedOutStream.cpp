@@ -0,0 +1,228 @@
+#include "CSegmentedOutStream.h"
+#include <mutex>
+
+// ************ Segment pool ************
+// Holds onto up to 64 MiB of released segments for reuse
+static const uint32 gkMaxPooledSegments = 256;
+static std::mutex gSegmentPoolMutex;
+static std::vector<uint8*> gSegmentPool;
+
+static uint8* AllocSegment()
+{
+    {
+        std::lock_guard<std::mutex> Lock(gSegmentPoolMutex);
+
+        if (!gSegmentPool.empty())
+        {
+            uint8 *pSegment = gSegmentPool.back();
+            gSegmentPool.pop_back();
+            return pSegment;
+        }
+    }
+
+    return new uint8[CSegmentedOutStream::skSegmentSize];
+}
+
+static void FreeSegment(uint8 *pSegment)
+{
+    {
+        std::lock_guard<std::mutex> Lock(gSegmentPoolMutex);
+
+        if (gSegmentPool.size() < gkMaxPooledSegments)
+        {
+            gSegmentPool.push_back(pSegment);
+            return;
+        }
+    }
+
+    delete[] pSegment;
+}
+
+// ************ CSegmentedOutStream ************
+CSegmentedOutStream::CSegmentedOutStream()
+    : mPos(0)
+    , mSize(0)
+{
+    mDataEndianness = EEndian::BigEndian;
+}
+
+CSegmentedOutStream::CSegmentedOutStream(EEndian DataEndianness)
+    : mPos(0)
+    , mSize(0)
+{
+    mDataEndianness = DataEndianness;
+}
+
+CSegmentedOutStream::CSegmentedOutStream(const CSegmentedOutStream& rkSrc)
+    : mPos(rkSrc.mPos)
+    , mSize(rkSrc.mSize)
+{
+    // Segments are owned by the stream, so copies need their own
+    mDataEndianness = rkSrc.mDataEndianness;
+    EnsureSegments(rkSrc.mSegments.size() * skSegmentSize);
+
+    for (uint32 SegmentIdx = 0; SegmentIdx < mSegments.size(); SegmentIdx++)
+        memcpy(mSegments[SegmentIdx], rkSrc.mSegments[SegmentIdx], skSegmentSize);
+}
+
+CSegmentedOutStream::~CSegmentedOutStream()
+{
+    Clear();
+}
+
+CSegmentedOutStream& CSegmentedOutStream::operator=(const CSegmentedOutStream& rkSrc)
+{
+    if (this != &rkSrc)
+    {
+        // Same as the copy constructor; sharing segment pointers would free them into the pool twice
+        Clear();
+        mDataEndianness = rkSrc.mDataEndianness;
+        EnsureSegments(rkSrc.mSegments.size() * skSegmentSize);
+
+        for (uint32 SegmentIdx = 0; SegmentIdx < mSegments.size(); SegmentIdx++)
+            memcpy(mSegments[SegmentIdx], rkSrc.mSegments[SegmentIdx], skSegmentSize);
+
+        mPos = rkSrc.mPos;
+        mSize = rkSrc.mSize;
+    }
+
+    return *this;
+}
+
+void CSegmentedOutStream::WriteBytes(const void *pkSrc, uint32 Count)
+{
+    // Writing past the end after a seek leaves a gap, which needs to read back as zeroes
+    if (mPos > mSize)
+        FillZero(mSize, mPos - mSize);
+
+    EnsureSegments(mPos + Count);
+    const uint8 *pkData = (const uint8*) pkSrc;
+
+    while (Count > 0)
+    {
+        uint32 SegmentPos = (uint32) (mPos % skSegmentSize);
+        uint32 CopySize = skSegmentSize - SegmentPos;
+        if (CopySize > Count) CopySize = Count;
+
+        memcpy(mSegments[(uint32) (mPos / skSegmentSize)] + SegmentPos, pkData, CopySize);
+        mPos += CopySize;
+        pkData += CopySize;
+        Count -= CopySize;
+    }
+
+    if (mPos > mSize) mSize = mPos;
+}
+
+bool CSegmentedOutStream::Seek64(int64 Offset, uint32 Origin)
+{
+    int64 NewPos;
+
+    switch (Origin)
+    {
+        case SEEK_SET:
+            NewPos = Offset;
+            break;
+
+        case SEEK_CUR:
+            NewPos = (int64) mPos + Offset;
+            break;
+
+        case SEEK_END:
+            NewPos = (int64) mSize - Offset;
+            break;
+
+        default:
+            return false;
+    }
+
+    if (NewPos < 0)
+        return false;
+
+    mPos = (uint64) NewPos;
+    return true;
+}
+
+uint64 CSegmentedOutStream::Tell64() const
+{
+    return mPos;
+}
+
+bool CSegmentedOutStream::EoF() const
+{
+    return (mPos >= mSize);
+}
+
+bool CSegmentedOutStream::IsValid() const
+{
+    return true;
+}
+
+uint64 CSegmentedOutStream::Size64() const
+{
+    return mSize;
+}
+
+void CSegmentedOutStream::CopyTo(void *pDst) const
+{
+    uint8 *pOut = (uint8*) pDst;
+    uint64 Remaining = mSize;
+
+    for (uint32 SegmentIdx = 0; Remaining > 0; SegmentIdx++)
+    {
+        uint32 CopySize = (Remaining < skSegmentSize ? (uint32) Remaining : skSegmentSize);
+        memcpy(pOut, mSegments[SegmentIdx], CopySize);
+        pOut += CopySize;
+        Remaining -= CopySize;
+    }
+}
+
+void CSegmentedOutStream::WriteTo(IOutputStream& rOutput) const
+{
+    std::vector<SWriteSegment> Segments;
+    Segments.reserve(mSegments.size());
+    uint64 Remaining = mSize;
+
+    for (uint32 SegmentIdx = 0; Remaining > 0; SegmentIdx++)
+    {
+        uint32 SegmentSize = (Remaining < skSegmentSize ? (uint32) Remaining : skSegmentSize);
+        Segments.push_back( SWriteSegment { mSegments[SegmentIdx], SegmentSize } );
+        Remaining -= SegmentSize;
+    }
+
+    rOutput.WriteSegments(Segments.data(), (uint32) Segments.size());
+}
+
+void CSegmentedOutStream::Clear()
+{
+    for (uint32 SegmentIdx = 0; SegmentIdx < mSegments.size(); SegmentIdx++)
+        FreeSegment(mSegments[SegmentIdx]);
+
+    mSegments.clear();
+    mPos = 0;
+    mSize = 0;
+}
+
+// ************ PRIVATE ************
+void CSegmentedOutStream::EnsureSegments(uint64 EndOffset)
+{
+    uint64 NumNeeded = (EndOffset + skSegmentSize - 1) / skSegmentSize;
+
+    while (mSegments.size() < NumNeeded)
+        mSegments.push_back(AllocSegment());
+}
+
+void CSegmentedOutStream::FillZero(uint64 Offset, uint64 Count)
+{
+    EnsureSegments(Offset + Count);
+
+    while (Count > 0)
+    {
+        uint32 SegmentPos = (uint32) (Offset % skSegmentSize);
+        uint32 FillSize = skSegmentSize - SegmentPos;
+        if (FillSize > Count) FillSize = (uint32) Count;
+
+        memset(mSegments[(uint32) (Offset / skSegmentSize)] + SegmentPos, 0, FillSize);
+        Offset += FillSize;
+        Count -= FillSize;
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef CSEGMENTEDOUTSTREAM_H
+#define CSEGMENTEDOUTSTREAM_H
+
+#include "IOutputStream.h"
+#include <vector>
+
+/**
+ * In-memory output stream made of a chain of fixed-size segments rather than one contiguous buffer,
+ * so growing it never copies what's already been written. Segments are taken from a process-wide
+ * pool and returned to it on Clear() or destruction. Seeking anywhere is allowed for backpatching.
+ * The result can be gathered with CopyTo(), or handed to another stream in one WriteSegments call
+ * with WriteTo() (which becomes a single gathered write for CFileOutStream).
+ */
+class CSegmentedOutStream : public IOutputStream
+{
+public:
+    static const uint32 skSegmentSize = 0x40000;
+
+private:
+    std::vector<uint8*> mSegments;
+    uint64 mPos;
+    uint64 mSize;
+
+    void EnsureSegments(uint64 EndOffset);
+    void FillZero(uint64 Offset, uint64 Count);
+
+public:
+    CSegmentedOutStream();
+    CSegmentedOutStream(EEndian DataEndianness);
+    CSegmentedOutStream(const CSegmentedOutStream& rkSrc);
+    ~CSegmentedOutStream();
+    CSegmentedOutStream& operator=(const CSegmentedOutStream& rkSrc);
+
+    void WriteBytes(const void *pkSrc, uint32 Count);
+    bool Seek64(int64 Offset, uint32 Origin);
+    uint64 Tell64() const;
+    bool EoF() const;
+    bool IsValid() const;
+    uint64 Size64() const;
+
+    void CopyTo(void *pDst) const;
+    void WriteTo(IOutputStream& rOutput) const;
+    void Clear();
+
+    inline uint32 NumSegments() const                   { return (uint32) mSegments.size(); }
+    inline const uint8* Segment(uint32 SegmentIdx) const { return mSegments[SegmentIdx]; }
+};
+
+#endif // CSEGMENTEDOUTSTREAM_H
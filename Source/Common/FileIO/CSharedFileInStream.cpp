@@ -0,0 +1,278 @@
+#include "CSharedFileInStream.h"
+#include "Common/Macros.h"
+
+#if _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ************ SSharedFile ************
+CSharedFileInStream::SSharedFile::SSharedFile()
+    : Size(0)
+#if _WIN32
+    , pHandle(nullptr)
+#else
+    , Descriptor(-1)
+#endif
+{
+}
+
+CSharedFileInStream::SSharedFile::~SSharedFile()
+{
+#if _WIN32
+    if (pHandle) CloseHandle((HANDLE) pHandle);
+#else
+    if (Descriptor >= 0) close(Descriptor);
+#endif
+}
+
+uint32 CSharedFileInStream::SSharedFile::ReadAt(uint64 Offset, void *pDst, uint32 Count) const
+{
+    // Positional reads don't depend on a file pointer, so this is safe to call from any thread
+    uint8 *pOut = (uint8*) pDst;
+    uint32 TotalRead = 0;
+
+#if _WIN32
+    // The handle is opened for overlapped I/O, so each call waits on its own event rather than on the handle
+    HANDLE Event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!Event) return 0;
+#endif
+
+    while (TotalRead < Count)
+    {
+#if _WIN32
+        OVERLAPPED Overlapped = {};
+        Overlapped.Offset = (DWORD) (Offset & 0xFFFFFFFF);
+        Overlapped.OffsetHigh = (DWORD) (Offset >> 32);
+        Overlapped.hEvent = Event;
+
+        if (!ReadFile((HANDLE) pHandle, pOut, Count - TotalRead, nullptr, &Overlapped) && GetLastError() != ERROR_IO_PENDING)
+            break;
+
+        DWORD NumRead = 0;
+        if (!GetOverlappedResult((HANDLE) pHandle, &Overlapped, &NumRead, TRUE) || NumRead == 0)
+            break;
+#else
+        ssize_t NumRead = pread(Descriptor, pOut, Count - TotalRead, (off_t) Offset);
+
+        if (NumRead < 0 && errno == EINTR)
+            continue;
+        if (NumRead <= 0)
+            break;
+#endif
+
+        pOut += NumRead;
+        Offset += NumRead;
+        TotalRead += (uint32) NumRead;
+    }
+
+#if _WIN32
+    CloseHandle(Event);
+#endif
+    return TotalRead;
+}
+
+// ************ CSharedFileInStream ************
+CSharedFileInStream::CSharedFileInStream()
+    : mBufferOffset(0)
+{
+}
+
+CSharedFileInStream::CSharedFileInStream(const TString& rkFile)
+    : CSharedFileInStream()
+{
+    Open(rkFile, EEndian::BigEndian);
+}
+
+CSharedFileInStream::CSharedFileInStream(const TString& rkFile, EEndian FileEndianness)
+    : CSharedFileInStream()
+{
+    Open(rkFile, FileEndianness);
+}
+
+CSharedFileInStream::CSharedFileInStream(const CSharedFileInStream& rkSrc)
+    : CSharedFileInStream()
+{
+    // Share the handle rather than reopening the file; the copy gets its own buffer and cursor
+    mpFile = rkSrc.mpFile;
+    mDataEndianness = rkSrc.mDataEndianness;
+    SetSourceString(rkSrc.GetSourceString());
+
+    if (IsValid())
+    {
+        mBuffer.resize(skBufferSize);
+        DiscardBuffer(rkSrc.Tell64());
+    }
+}
+
+CSharedFileInStream::~CSharedFileInStream()
+{
+    if (IsValid())
+        Close();
+}
+
+void CSharedFileInStream::Open(const TString& rkFile, EEndian FileEndianness)
+{
+    if (IsValid())
+        Close();
+
+    mDataEndianness = FileEndianness;
+    SetSourceString(rkFile.GetFileName());
+    std::shared_ptr<SSharedFile> pFile = std::make_shared<SSharedFile>();
+    pFile->Name = rkFile;
+
+#if _WIN32
+    HANDLE File = CreateFileW(ToWChar(rkFile), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (File == INVALID_HANDLE_VALUE) return;
+    pFile->pHandle = File;
+
+    LARGE_INTEGER FileSize;
+    if (!GetFileSizeEx(File, &FileSize)) return;
+    pFile->Size = (uint64) FileSize.QuadPart;
+#else
+    pFile->Descriptor = open(*rkFile, O_RDONLY);
+    if (pFile->Descriptor < 0) return;
+
+    struct stat FileStat;
+    if (fstat(pFile->Descriptor, &FileStat) != 0) return;
+    pFile->Size = (uint64) FileStat.st_size;
+#endif
+
+    mpFile = pFile;
+    mBuffer.resize(skBufferSize);
+    DiscardBuffer(0);
+}
+
+void CSharedFileInStream::Close()
+{
+    // Only releases this stream's reference; the file stays open for any copies still using it
+    mpFile.reset();
+    mpReadCursor = nullptr;
+    mpReadLimit = nullptr;
+    mBufferOffset = 0;
+}
+
+void CSharedFileInStream::ReadBytes(void *pDst, uint32 Count)
+{
+    if (!IsValid()) return;
+    uint8 *pOut = (uint8*) pDst;
+
+    while (Count > 0)
+    {
+        // Drain whatever is left in the buffer first
+        uint32 Buffered = (uint32) (mpReadLimit - mpReadCursor);
+
+        if (Buffered > 0)
+        {
+            uint32 CopySize = (Count < Buffered ? Count : Buffered);
+            memcpy(pOut, mpReadCursor, CopySize);
+            mpReadCursor += CopySize;
+            pOut += CopySize;
+            Count -= CopySize;
+        }
+
+        // Large reads bypass the buffer and go straight to the destination
+        else if (Count >= skBufferSize)
+        {
+            uint64 Offset = Tell64();
+            uint32 NumRead = mpFile->ReadAt(Offset, pOut, Count);
+            DiscardBuffer(Offset + NumRead);
+            break;
+        }
+
+        else
+        {
+            FillBuffer(Tell64());
+            if (mpReadCursor == mpReadLimit) break;
+        }
+    }
+}
+
+bool CSharedFileInStream::Seek64(int64 Offset, uint32 Origin)
+{
+    if (!IsValid()) return false;
+    int64 NewPos;
+
+    switch (Origin)
+    {
+        case SEEK_SET:
+            NewPos = Offset;
+            break;
+
+        case SEEK_CUR:
+            NewPos = (int64) Tell64() + Offset;
+            break;
+
+        case SEEK_END:
+            NewPos = (int64) mpFile->Size + Offset;
+            break;
+
+        default:
+            return false;
+    }
+
+    if (NewPos < 0)
+        return false;
+
+    // Seeks that land inside the buffer just move the cursor. Anything else only drops the
+    // buffer; there's no file pointer to move, so the next read simply starts at the new offset.
+    const uint8 *pkBufferStart = mBuffer.data();
+    uint64 BufferEnd = mBufferOffset + (mpReadLimit - pkBufferStart);
+
+    if ((uint64) NewPos >= mBufferOffset && (uint64) NewPos <= BufferEnd)
+        mpReadCursor = pkBufferStart + (NewPos - mBufferOffset);
+    else
+        DiscardBuffer(NewPos);
+
+    return true;
+}
+
+uint64 CSharedFileInStream::Tell64() const
+{
+    if (!IsValid()) return 0;
+    return mBufferOffset + (mpReadCursor - mBuffer.data());
+}
+
+bool CSharedFileInStream::EoF() const
+{
+    return (!IsValid() || Tell64() >= mpFile->Size);
+}
+
+bool CSharedFileInStream::IsValid() const
+{
+    return (mpFile != nullptr);
+}
+
+uint64 CSharedFileInStream::Size64() const
+{
+    return (IsValid() ? mpFile->Size : 0);
+}
+
+TString CSharedFileInStream::FileName() const
+{
+    return (IsValid() ? mpFile->Name : "");
+}
+
+// ************ PRIVATE ************
+void CSharedFileInStream::FillBuffer(uint64 FileOffset)
+{
+    uint32 NumRead = mpFile->ReadAt(FileOffset, mBuffer.data(), skBufferSize);
+    mBufferOffset = FileOffset;
+    mpReadCursor = mBuffer.data();
+    mpReadLimit = mpReadCursor + NumRead;
+}
+
+void CSharedFileInStream::DiscardBuffer(uint64 FileOffset)
+{
+    // Empties the window; the next read will refill the buffer starting at FileOffset
+    mBufferOffset = FileOffset;
+    mpReadCursor = mBuffer.data();
+    mpReadLimit = mpReadCursor;
+}
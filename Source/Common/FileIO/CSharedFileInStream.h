@@ -0,0 +1,71 @@
+#ifndef CSHAREDFILEINSTREAM_H
+#define CSHAREDFILEINSTREAM_H
+
+#include "IInputStream.h"
+#include <memory>
+
+/**
+ * File input stream built on positional reads (pread/overlapped ReadFile), so it never depends on
+ * a shared file pointer. Copying the stream is cheap: the copy shares the open file handle and gets
+ * its own cursor and buffer, and copies can then be read from different threads concurrently. On
+ * Windows the handle is opened with FILE_FLAG_OVERLAPPED; a synchronous handle would make the system
+ * queue up reads from every copy one after another. The handle is closed once the last stream using it goes away.
+ *
+ * For multithreaded loading, open the file once on the main thread, then give each worker its own
+ * copy and its own archive on top of it. Archives aren't thread-safe either, so they shouldn't be shared:
+ *
+ *     CSharedFileInStream File(Path, EEndian::BigEndian);
+ *
+ *     // On each worker thread
+ *     CSharedFileInStream WorkerFile(File);
+ *     WorkerFile.GoTo(AssetOffset);
+ *     CBasicBinaryReader Reader(&WorkerFile, Version);
+ *
+ * Copies should be made from a stream that isn't being read from at the same time.
+ */
+class CSharedFileInStream : public IInputStream
+{
+private:
+    static const uint32 skBufferSize = 0x10000;
+
+    struct SSharedFile
+    {
+        TString Name;
+        uint64 Size;
+#if _WIN32
+        void *pHandle;
+#else
+        int Descriptor;
+#endif
+
+        SSharedFile();
+        ~SSharedFile();
+        uint32 ReadAt(uint64 Offset, void *pDst, uint32 Count) const;
+    };
+
+    std::shared_ptr<SSharedFile> mpFile;
+    std::vector<uint8> mBuffer;
+    uint64 mBufferOffset; // File offset of the first byte in the buffer
+
+    void FillBuffer(uint64 FileOffset);
+    void DiscardBuffer(uint64 FileOffset);
+
+public:
+    CSharedFileInStream();
+    CSharedFileInStream(const TString& rkFile);
+    CSharedFileInStream(const TString& rkFile, EEndian FileEndianness);
+    CSharedFileInStream(const CSharedFileInStream& rkSrc);
+    ~CSharedFileInStream();
+    void Open(const TString& rkFile, EEndian FileEndianness);
+    void Close();
+
+    void ReadBytes(void *pDst, uint32 Count);
+    bool Seek64(int64 Offset, uint32 Origin);
+    uint64 Tell64() const;
+    bool EoF() const;
+    bool IsValid() const;
+    uint64 Size64() const;
+    TString FileName() const;
+};
+
+#endif // CSHAREDFILEINSTREAM_H
@@ -0,0 +1,235 @@
+#include "CSubInStream.h"
+#include "Common/Macros.h"
+
+CSubInStream::CSubInStream()
+    : mpParent(nullptr)
+    , mpDataStart(nullptr)
+    , mOffset(0)
+    , mSize(0)
+    , mBufferOffset(0)
+{
+}
+
+CSubInStream::CSubInStream(IInputStream *pParent, uint64 Offset, uint64 Size)
+    : CSubInStream()
+{
+    SetRange(pParent, Offset, Size);
+}
+
+CSubInStream::~CSubInStream()
+{
+}
+
+void CSubInStream::SetRange(IInputStream *pParent, uint64 Offset, uint64 Size)
+{
+    ASSERT(pParent && pParent->IsValid());
+    mpParent = nullptr;
+    mpDataStart = nullptr;
+    mpReadCursor = nullptr;
+    mpReadLimit = nullptr;
+    mDataEndianness = pParent->GetEndianness();
+    SetSourceString(pParent->GetSourceString());
+
+    // Ranges usually come from file data, so they're checked in every build
+    uint64 ParentSize = pParent->Size64();
+
+    if (Offset > ParentSize || Size > ParentSize - Offset)
+    {
+        errorf("%s: Sub-stream range is outside the parent stream", *GetSourceString());
+        mOffset = 0;
+        mSize = 0;
+        return;
+    }
+
+    mpParent = pParent;
+    mOffset = Offset;
+    mSize = Size;
+
+    // For memory-backed parents the whole range becomes the read window, so reads never touch the parent
+    if (pParent->IsMemoryBacked())
+    {
+        mpDataStart = (const uint8*) pParent->Data() + Offset;
+        mpReadCursor = mpDataStart;
+        mpReadLimit = mpDataStart + Size;
+    }
+    else
+    {
+        mBuffer.resize(skBufferSize);
+        DiscardBuffer(0);
+    }
+}
+
+void CSubInStream::ReadBytes(void *pDst, uint32 Count)
+{
+    if (!IsValid()) return;
+
+    if (mpDataStart)
+    {
+        uint64 Remaining = (uint64) (mpReadLimit - mpReadCursor);
+        if (Count > Remaining) Count = (uint32) Remaining;
+
+        memcpy(pDst, mpReadCursor, Count);
+        mpReadCursor += Count;
+    }
+    else
+    {
+        uint64 Pos = Tell64();
+        uint64 Remaining = (Pos < mSize ? mSize - Pos : 0);
+        if (Count > Remaining) Count = (uint32) Remaining;
+        uint8 *pOut = (uint8*) pDst;
+
+        while (Count > 0)
+        {
+            // Drain whatever is left in the buffer first
+            uint32 Buffered = (uint32) (mpReadLimit - mpReadCursor);
+
+            if (Buffered > 0)
+            {
+                uint32 CopySize = (Count < Buffered ? Count : Buffered);
+                memcpy(pOut, mpReadCursor, CopySize);
+                mpReadCursor += CopySize;
+                pOut += CopySize;
+                Count -= CopySize;
+            }
+
+            // Large reads bypass the buffer and go straight to the destination
+            else if (Count >= skBufferSize)
+            {
+                Pos = Tell64();
+                mpParent->GoTo(mOffset + Pos);
+                mpParent->ReadBytes(pOut, Count);
+                DiscardBuffer(Pos + Count);
+                break;
+            }
+
+            else
+            {
+                FillBuffer();
+                if (mpReadCursor == mpReadLimit) break;
+            }
+        }
+    }
+}
+
+const void* CSubInStream::ReadSpan(uint32 Count)
+{
+    // Returns a pointer directly into the parent's data and advances past it. Fails if the
+    // parent isn't memory-backed or if there aren't Count bytes left.
+    if (!mpDataStart || Count > (uint64) (mpReadLimit - mpReadCursor))
+        return nullptr;
+
+    const void *pkSpan = mpReadCursor;
+    mpReadCursor += Count;
+    return pkSpan;
+}
+
+bool CSubInStream::Seek64(int64 Offset, uint32 Origin)
+{
+    if (!IsValid()) return false;
+    int64 NewPos;
+
+    switch (Origin)
+    {
+        case SEEK_SET:
+            NewPos = Offset;
+            break;
+
+        case SEEK_CUR:
+            NewPos = (int64) Tell64() + Offset;
+            break;
+
+        case SEEK_END:
+            NewPos = (int64) mSize - Offset;
+            break;
+
+        default:
+            return false;
+    }
+
+    bool Success = true;
+
+    if (NewPos < 0)
+    {
+        NewPos = 0;
+        Success = false;
+    }
+
+    if (NewPos > (int64) mSize)
+    {
+        NewPos = mSize;
+        Success = false;
+    }
+
+    if (mpDataStart)
+        mpReadCursor = mpDataStart + NewPos;
+
+    // Seeks that land inside the buffer just move the cursor
+    else if ((uint64) NewPos >= mBufferOffset && (uint64) NewPos <= mBufferOffset + (mpReadLimit - mBuffer.data()))
+        mpReadCursor = mBuffer.data() + (NewPos - mBufferOffset);
+    else
+        DiscardBuffer(NewPos);
+
+    return Success;
+}
+
+uint64 CSubInStream::Tell64() const
+{
+    if (mpDataStart)
+        return (uint64) (mpReadCursor - mpDataStart);
+    else
+        return mBufferOffset + (mpReadCursor - mBuffer.data());
+}
+
+bool CSubInStream::EoF() const
+{
+    return (Tell64() >= mSize);
+}
+
+bool CSubInStream::IsValid() const
+{
+    return (mpParent != nullptr && mpParent->IsValid());
+}
+
+uint64 CSubInStream::Size64() const
+{
+    return mSize;
+}
+
+bool CSubInStream::IsMemoryBacked() const
+{
+    return (mpDataStart != nullptr);
+}
+
+const void* CSubInStream::Data() const
+{
+    return mpDataStart;
+}
+
+uint64 CSubInStream::ParentOffset() const
+{
+    return mOffset;
+}
+
+// ************ PRIVATE ************
+void CSubInStream::FillBuffer()
+{
+    // Only called once the window is exhausted; refills it from the next part of the range
+    ASSERT(mpReadCursor == mpReadLimit);
+    mBufferOffset += (mpReadLimit - mBuffer.data());
+
+    uint64 Remaining = (mBufferOffset < mSize ? mSize - mBufferOffset : 0);
+    uint32 FillSize = (Remaining < skBufferSize ? (uint32) Remaining : skBufferSize);
+
+    mpParent->GoTo(mOffset + mBufferOffset);
+    mpParent->ReadBytes(mBuffer.data(), FillSize);
+    mpReadCursor = mBuffer.data();
+    mpReadLimit = mpReadCursor + FillSize;
+}
+
+void CSubInStream::DiscardBuffer(uint64 Offset)
+{
+    // Empties the window; the next read refills it from Offset
+    mBufferOffset = Offset;
+    mpReadCursor = mBuffer.data();
+    mpReadLimit = mpReadCursor;
+}
@@ -0,0 +1,50 @@
+#ifndef CSUBINSTREAM_H
+#define CSUBINSTREAM_H
+
+#include "IInputStream.h"
+
+/**
+ * View of the [Offset, Offset + Size) range of a parent stream, for reading an embedded file
+ * without extracting it first. Positions, EoF and Size are all relative to the range. If the
+ * parent is memory-backed, the view reads straight from the parent's data and is memory-backed
+ * itself; otherwise reads go through a small buffer that's filled by seeking the parent, so the
+ * parent shouldn't be used from elsewhere while the view is being read. The parent must outlive
+ * the view. Ranges that don't fit in the parent leave the view invalid.
+ */
+class CSubInStream : public IInputStream
+{
+    static const uint32 skBufferSize = 0x1000;
+
+    IInputStream *mpParent;
+    const uint8 *mpDataStart; // Only set if the parent is memory-backed
+    uint64 mOffset;
+    uint64 mSize;
+
+    // Only used if the parent isn't memory-backed
+    std::vector<uint8> mBuffer;
+    uint64 mBufferOffset;     // Range offset of the first byte in the buffer
+
+    void FillBuffer();
+    void DiscardBuffer(uint64 Offset);
+
+public:
+    CSubInStream();
+    CSubInStream(IInputStream *pParent, uint64 Offset, uint64 Size);
+    ~CSubInStream();
+    CSubInStream(const CSubInStream&) = delete;
+    CSubInStream& operator=(const CSubInStream&) = delete;
+    void SetRange(IInputStream *pParent, uint64 Offset, uint64 Size);
+
+    void ReadBytes(void *pDst, uint32 Count);
+    const void* ReadSpan(uint32 Count);
+    bool Seek64(int64 Offset, uint32 Origin);
+    uint64 Tell64() const;
+    bool EoF() const;
+    bool IsValid() const;
+    uint64 Size64() const;
+    bool IsMemoryBacked() const;
+    const void* Data() const;
+    uint64 ParentOffset() const;
+};
+
+#endif // CSUBINSTREAM_H
@@ -42,12 +42,12 @@ void CVectorOutStream::WriteBytes(const void *pkSrc, uint32 Count)
 {
     if (!IsValid()) return;
 
-    uint32 NewSize = mPos + Count;
+    uint64 NewSize = mPos + Count;
 
     if (NewSize > mpVector->size())
     {
         if (NewSize > mpVector->capacity())
-            mpVector->reserve( ALIGN(mPos + Count, skAllocSize) );
+            mpVector->reserve( ALIGN(GrowCapacity(NewSize), skAllocSize) );
 
         mpVector->resize(NewSize);
     }
@@ -56,41 +56,71 @@ void CVectorOutStream::WriteBytes(const void *pkSrc, uint32 Count)
     mPos += Count;
 }
 
-bool CVectorOutStream::Seek(int32 Offset, uint32 Origin)
+void CVectorOutStream::WriteSegments(const SWriteSegment *pkSegments, uint32 NumSegments)
+{
+    if (!IsValid()) return;
+
+    // Grow the vector once for the whole batch, then copy each segment in
+    uint64 TotalSize = 0;
+
+    for (uint32 SegIdx = 0; SegIdx < NumSegments; SegIdx++)
+        TotalSize += pkSegments[SegIdx].Size;
+
+    uint64 NewSize = mPos + TotalSize;
+
+    if (NewSize > mpVector->size())
+    {
+        if (NewSize > mpVector->capacity())
+            mpVector->reserve( ALIGN(GrowCapacity(NewSize), skAllocSize) );
+
+        mpVector->resize(NewSize);
+    }
+
+    for (uint32 SegIdx = 0; SegIdx < NumSegments; SegIdx++)
+    {
+        memcpy(mpVector->data() + mPos, pkSegments[SegIdx].pkData, pkSegments[SegIdx].Size);
+        mPos += pkSegments[SegIdx].Size;
+    }
+}
+
+bool CVectorOutStream::Seek64(int64 Offset, uint32 Origin)
 {
     if (!IsValid()) return false;
+    int64 NewPos;
 
     switch (Origin)
     {
         case SEEK_SET:
-            mPos = Offset;
+            NewPos = Offset;
             break;
 
         case SEEK_CUR:
-            mPos += Offset;
+            NewPos = (int64) mPos + Offset;
             break;
 
         case SEEK_END:
-            mPos = mpVector->size() - Offset;
+            NewPos = (int64) mpVector->size() - Offset;
             break;
 
         default:
             return false;
     }
 
-    if (mPos < 0)
+    if (NewPos < 0)
     {
         mPos = 0;
         return false;
     }
 
+    mPos = (uint64) NewPos;
+
     if (mPos > mpVector->size())
         mpVector->resize(mPos);
 
     return true;
 }
 
-uint32 CVectorOutStream::Tell() const
+uint64 CVectorOutStream::Tell64() const
 {
     return mPos;
 }
@@ -105,7 +135,7 @@ bool CVectorOutStream::IsValid() const
     return true;
 }
 
-uint32 CVectorOutStream::Size() const
+uint64 CVectorOutStream::Size64() const
 {
     return mPos;
 }
@@ -137,3 +167,11 @@ void CVectorOutStream::Clear()
     mPos = 0;
     mpVector->clear();
 }
+
+// ************ PRIVATE ************
+uint64 CVectorOutStream::GrowCapacity(uint64 NewSize) const
+{
+    // Grow geometrically; reserving the exact size would reallocate and copy on nearly every write
+    uint64 Doubled = mpVector->capacity() * 2;
+    return (NewSize > Doubled ? NewSize : Doubled);
+}
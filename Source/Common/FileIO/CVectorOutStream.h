@@ -10,7 +10,9 @@ class CVectorOutStream : public IOutputStream
 
     std::vector<char> *mpVector;
     bool mOwnsVector;
-    uint32 mPos;
+    uint64 mPos;
+
+    uint64 GrowCapacity(uint64 NewSize) const;
 
 public:
     CVectorOutStream();
@@ -20,11 +22,12 @@ public:
     ~CVectorOutStream();
 
     void WriteBytes(const void *pkSrc, uint32 Count);
-    bool Seek(int32 Offset, uint32 Origin);
-    uint32 Tell() const;
+    void WriteSegments(const SWriteSegment *pkSegments, uint32 NumSegments);
+    bool Seek64(int64 Offset, uint32 Origin);
+    uint64 Tell64() const;
     bool EoF() const;
     bool IsValid() const;
-    uint32 Size() const;
+    uint64 Size64() const;
     void SetVector(std::vector<char> *pVector);
     void *Data();
     void *DataAtPosition();
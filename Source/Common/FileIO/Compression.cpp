@@ -0,0 +1,117 @@
+#include "Compression.h"
+
+#if WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#if WITH_LZ4
+#include <lz4.h>
+#endif
+
+#if WITH_ZSTD
+#include <zstd.h>
+#endif
+
+bool IsCodecSupported(ECompressionCodec Codec)
+{
+    switch (Codec)
+    {
+    case ECompressionCodec::None:   return true;
+#if WITH_ZLIB
+    case ECompressionCodec::Zlib:   return true;
+#endif
+#if WITH_LZ4
+    case ECompressionCodec::LZ4:    return true;
+#endif
+#if WITH_ZSTD
+    case ECompressionCodec::Zstd:   return true;
+#endif
+    default:                        return false;
+    }
+}
+
+bool CompressBlock(ECompressionCodec Codec, const void *pkSrc, uint32 SrcSize, std::vector<uint8>& rDst)
+{
+    uint32 DstSize = 0;
+
+    switch (Codec)
+    {
+#if WITH_ZLIB
+    case ECompressionCodec::Zlib:
+    {
+        uLongf ZlibSize = compressBound(SrcSize);
+        rDst.resize(ZlibSize);
+
+        if (compress2(rDst.data(), &ZlibSize, (const Bytef*) pkSrc, SrcSize, Z_DEFAULT_COMPRESSION) != Z_OK)
+            return false;
+
+        DstSize = (uint32) ZlibSize;
+        break;
+    }
+#endif
+
+#if WITH_LZ4
+    case ECompressionCodec::LZ4:
+    {
+        rDst.resize(LZ4_compressBound(SrcSize));
+        int LZ4Size = LZ4_compress_default((const char*) pkSrc, (char*) rDst.data(), SrcSize, (int) rDst.size());
+
+        if (LZ4Size <= 0)
+            return false;
+
+        DstSize = (uint32) LZ4Size;
+        break;
+    }
+#endif
+
+#if WITH_ZSTD
+    case ECompressionCodec::Zstd:
+    {
+        rDst.resize(ZSTD_compressBound(SrcSize));
+        size_t ZstdSize = ZSTD_compress(rDst.data(), rDst.size(), pkSrc, SrcSize, ZSTD_CLEVEL_DEFAULT);
+
+        if (ZSTD_isError(ZstdSize))
+            return false;
+
+        DstSize = (uint32) ZstdSize;
+        break;
+    }
+#endif
+
+    default:
+        return false;
+    }
+
+    if (DstSize >= SrcSize)
+        return false;
+
+    rDst.resize(DstSize);
+    return true;
+}
+
+bool DecompressBlock(ECompressionCodec Codec, const void *pkSrc, uint32 SrcSize, void *pDst, uint32 DstSize)
+{
+    switch (Codec)
+    {
+#if WITH_ZLIB
+    case ECompressionCodec::Zlib:
+    {
+        uLongf ZlibSize = DstSize;
+        return uncompress((Bytef*) pDst, &ZlibSize, (const Bytef*) pkSrc, SrcSize) == Z_OK && ZlibSize == DstSize;
+    }
+#endif
+
+#if WITH_LZ4
+    case ECompressionCodec::LZ4:
+        return LZ4_decompress_safe((const char*) pkSrc, (char*) pDst, SrcSize, DstSize) == (int) DstSize;
+#endif
+
+#if WITH_ZSTD
+    case ECompressionCodec::Zstd:
+        return ZSTD_decompress(pDst, DstSize, pkSrc, SrcSize) == DstSize;
+#endif
+
+    default:
+        return false;
+    }
+}
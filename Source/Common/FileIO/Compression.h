@@ -0,0 +1,36 @@
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include "Common/BasicTypes.h"
+#include <vector>
+
+/** Block compression codecs. Each one is only available if the library was built with it (WITH_ZLIB, WITH_LZ4, WITH_ZSTD). */
+enum class ECompressionCodec
+{
+    None,
+    Zlib,
+    LZ4,
+    Zstd
+};
+
+/** Layout used by CCompressedOutStream/CCompressedInStream. Integers are little endian.
+ *  Header:  FourCC 'CMPS', uint32 Codec, uint32 BlockSize
+ *  Blocks:  Compressed blocks, back-to-back. Every block but the last decompresses to BlockSize bytes.
+ *  Index:   uint32 compressed size per block; the top bit is set on blocks that are stored uncompressed
+ *  Trailer: uint64 UncompressedSize, uint64 IndexOffset, uint32 NumBlocks, FourCC 'CMPS'
+ */
+const uint32 gkCompressedStreamMagic = 0x434D5053; // 'CMPS'
+const uint32 gkCompressedStreamHeaderSize = 12;
+const uint32 gkCompressedStreamTrailerSize = 24;
+const uint32 gkStoredBlockFlag = 0x80000000;
+const uint32 gkMaxCompressedBlockSize = 0x4000000; // Readers reject larger blocks so a corrupt header can't make them allocate gigabytes
+
+bool IsCodecSupported(ECompressionCodec Codec);
+
+// Compresses a block into rDst. Returns false if the codec isn't supported or the data didn't shrink.
+bool CompressBlock(ECompressionCodec Codec, const void *pkSrc, uint32 SrcSize, std::vector<uint8>& rDst);
+
+// Decompresses a block that is known to decompress to exactly DstSize bytes.
+bool DecompressBlock(ECompressionCodec Codec, const void *pkSrc, uint32 SrcSize, void *pDst, uint32 DstSize);
+
+#endif // COMPRESSION_H
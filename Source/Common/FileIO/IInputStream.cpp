@@ -7,93 +7,110 @@ IInputStream::~IInputStream()
 
 bool IInputStream::ReadBool()
 {
-    char Val;
-    ReadBytes(&Val, 1);
+    char Val = ReadValue<char>();
     ASSERT(Val == 0 || Val == 1);
     return (Val != 0 ? true : false);
 }
 
-int8 IInputStream::ReadByte()
+uint64 IInputStream::ReadVarIntSlow()
 {
-    int8 Val;
-    ReadBytes(&Val, 1);
-    return Val;
-}
+    // Byte-at-a-time decode for varints longer than 8 bytes or near the end of the read window
+    uint64 Val = 0;
+    uint32 Shift = 0;
+    uint8 Byte;
 
-int16 IInputStream::ReadShort()
-{
-    int16 Val;
-    ReadBytes(&Val, 2);
-    if (mDataEndianness != EEndian::SystemEndian) SwapBytes(Val);
-    return Val;
-}
+    do
+    {
+        Byte = ReadValue<uint8>();
+        Val |= (uint64) (Byte & 0x7F) << Shift;
+        Shift += 7;
+    }
+    while ((Byte & 0x80) && Shift < 64);
 
-int32 IInputStream::ReadLong()
-{
-    int32 Val;
-    ReadBytes(&Val, 4);
-    if (mDataEndianness != EEndian::SystemEndian) SwapBytes(Val);
     return Val;
 }
 
-int64 IInputStream::ReadLongLong()
+uint32 IInputStream::ReadFourCC()
 {
-    int64 Val;
-    ReadBytes(&Val, 8);
-    if (mDataEndianness != EEndian::SystemEndian) SwapBytes(Val);
+    uint32 Val = ReadValue<uint32>();
+    if (EEndian::SystemEndian == EEndian::LittleEndian) SwapBytes(Val);
     return Val;
 }
 
-float IInputStream::ReadFloat()
+TString IInputStream::ReadString()
 {
-    float Val;
-    ReadBytes(&Val, 4);
-    if (mDataEndianness != EEndian::SystemEndian) SwapBytes(Val);
-    return Val;
+    return ReadStringView().ToString();
 }
 
-double IInputStream::ReadDouble()
+TString IInputStream::ReadString(uint32 Count)
 {
-    double Val;
-    ReadBytes(&Val, 8);
-    if (mDataEndianness != EEndian::SystemEndian) SwapBytes(Val);
-    return Val;
+    TString Str(Count, 0);
+    ReadBytes(&Str[0], Count);
+    return Str;
 }
 
-uint32 IInputStream::ReadFourCC()
+TString IInputStream::ReadSizedString()
 {
-    uint32 Val;
-    ReadBytes(&Val, 4);
-    if (EEndian::SystemEndian == EEndian::LittleEndian) SwapBytes(Val);
-    return Val;
+    uint32 StringSize = ReadLong();
+    return ReadString(StringSize);
 }
 
-TString IInputStream::ReadString()
+CStringView IInputStream::ReadStringView()
 {
-    TString Str;
-    char Chr;
+    // Fast path: the whole string is in the read window
+    size_t Available = (size_t) (mpReadLimit - mpReadCursor);
+    const char *pkStart = (const char*) mpReadCursor;
+    const char *pkEnd = (Available > 0 ? (const char*) memchr(pkStart, 0, Available) : nullptr);
 
-    do
+    if (pkEnd)
     {
-        Chr = ReadByte();
-        if (Chr != 0) Str.Append(Chr);
+        mpReadCursor = (const uint8*) pkEnd + 1;
+        return CStringView(pkStart, (uint32) (pkEnd - pkStart));
     }
-    while ((Chr != 0) && (!EoF()));
 
-    return Str;
-}
+    // Otherwise gather it into the string buffer a window at a time
+    mStringBuffer.clear();
 
-TString IInputStream::ReadString(uint32 Count)
-{
-    TString Str(Count, 0);
-    ReadBytes(&Str[0], Count);
-    return Str;
+    while (true)
+    {
+        Available = (size_t) (mpReadLimit - mpReadCursor);
+        pkStart = (const char*) mpReadCursor;
+        pkEnd = (Available > 0 ? (const char*) memchr(pkStart, 0, Available) : nullptr);
+
+        if (pkEnd)
+        {
+            mStringBuffer.insert(mStringBuffer.end(), pkStart, pkEnd);
+            mpReadCursor = (const uint8*) pkEnd + 1;
+            break;
+        }
+
+        mStringBuffer.insert(mStringBuffer.end(), pkStart, pkStart + Available);
+        mpReadCursor = mpReadLimit;
+        if (EoF()) break;
+
+        // Reading a single byte refills the window on buffered streams
+        char Chr = ReadValue<char>();
+        if (Chr == 0) break;
+        mStringBuffer.push_back(Chr);
+    }
+
+    return CStringView(mStringBuffer.data(), (uint32) mStringBuffer.size());
 }
 
-TString IInputStream::ReadSizedString()
+CStringView IInputStream::ReadSizedStringView()
 {
     uint32 StringSize = ReadLong();
-    return ReadString(StringSize);
+
+    if ((uint64) (mpReadLimit - mpReadCursor) >= StringSize)
+    {
+        const char *pkStart = (const char*) mpReadCursor;
+        mpReadCursor += StringSize;
+        return CStringView(pkStart, StringSize);
+    }
+
+    mStringBuffer.resize(StringSize);
+    ReadBytes(mStringBuffer.data(), StringSize);
+    return CStringView(mStringBuffer.data(), StringSize);
 }
 
 T16String IInputStream::Read16String()
@@ -129,45 +146,40 @@ T16String IInputStream::ReadSized16String()
     return Read16String(StringSize);
 }
 
-int8 IInputStream::PeekByte()
+void IInputStream::ReadArray(int16 *pDst, uint32 Count)
 {
-    int8 Val = ReadByte();
-    Seek(-1, SEEK_CUR);
-    return Val;
+    ReadBytes(pDst, Count * sizeof(int16));
+    if (mDataEndianness != EEndian::SystemEndian) SwapBytesArray(pDst, Count);
 }
 
-int16 IInputStream::PeekShort()
+void IInputStream::ReadArray(int32 *pDst, uint32 Count)
 {
-    int16 Val = ReadShort();
-    Seek(-2, SEEK_CUR);
-    return Val;
+    ReadBytes(pDst, Count * sizeof(int32));
+    if (mDataEndianness != EEndian::SystemEndian) SwapBytesArray(pDst, Count);
 }
 
-int32 IInputStream::PeekLong()
+void IInputStream::ReadArray(int64 *pDst, uint32 Count)
 {
-    int32 Val = ReadLong();
-    Seek(-4, SEEK_CUR);
-    return Val;
+    ReadBytes(pDst, Count * sizeof(int64));
+    if (mDataEndianness != EEndian::SystemEndian) SwapBytesArray(pDst, Count);
 }
 
-int64 IInputStream::PeekLongLong()
+void IInputStream::ReadArray(float *pDst, uint32 Count)
 {
-    int64 Val = ReadLongLong();
-    Seek(-8, SEEK_CUR);
-    return Val;
+    ReadBytes(pDst, Count * sizeof(float));
+    if (mDataEndianness != EEndian::SystemEndian) SwapBytesArray(pDst, Count);
 }
 
-float IInputStream::PeekFloat()
+void IInputStream::ReadArray(double *pDst, uint32 Count)
 {
-    float Val = ReadFloat();
-    Seek(-4, SEEK_CUR);
-    return Val;
+    ReadBytes(pDst, Count * sizeof(double));
+    if (mDataEndianness != EEndian::SystemEndian) SwapBytesArray(pDst, Count);
 }
 
-double IInputStream::PeekDouble()
+int8 IInputStream::PeekByte()
 {
-    double Val = ReadDouble();
-    Seek(-8, SEEK_CUR);
+    int8 Val = ReadByte();
+    Seek(-1, SEEK_CUR);
     return Val;
 }
 
@@ -178,21 +190,21 @@ uint32 IInputStream::PeekFourCC()
     return Val;
 }
 
-bool IInputStream::GoTo(uint32 Address)
+bool IInputStream::GoTo(uint64 Address)
 {
-    return Seek(Address, SEEK_SET);
+    return Seek64(Address, SEEK_SET);
 }
 
-bool IInputStream::Skip(int32 SkipAmount)
+bool IInputStream::Skip(int64 SkipAmount)
 {
-    return Seek(SkipAmount, SEEK_CUR);
+    return Seek64(SkipAmount, SEEK_CUR);
 }
 
 void IInputStream::SeekToBoundary(uint32 Boundary)
 {
-    uint32 Num = Boundary - (Tell() % Boundary);
+    uint32 Num = Boundary - (uint32) (Tell64() % Boundary);
     if (Num == Boundary) return;
-    else Seek(Num, SEEK_CUR);
+    else Seek64(Num, SEEK_CUR);
 }
 
 void IInputStream::SetEndianness(EEndian Endianness)
@@ -215,12 +227,12 @@ TString IInputStream::GetSourceString() const
     return mDataSource;
 }
 
-bool IInputStream::Seek64(int64 Offset, uint32 Origin)
+bool IInputStream::IsMemoryBacked() const
 {
-    return Seek((int32) Offset, Origin);
+    return false;
 }
 
-uint64 IInputStream::Tell64() const
+const void* IInputStream::Data() const
 {
-    return (uint64) Tell();
+    return nullptr;
 }
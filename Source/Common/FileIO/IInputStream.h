@@ -11,33 +11,133 @@ class IInputStream
 protected:
     EEndian mDataEndianness;
     TString mDataSource;
-    
+
+    /**
+     * Read window. Streams that have their upcoming data available in memory point these at it
+     * (cursor = next byte to read, limit = end of the available data) and refill it in bulk from
+     * ReadBytes(). Primitive reads consume straight from the window without a virtual call, and
+     * only fall back to ReadBytes() when the window runs dry. Streams without one leave both null.
+     * Any stream that sets up a window must account for it in Seek64() and Tell64().
+     */
+    const uint8 *mpReadCursor;
+    const uint8 *mpReadLimit;
+
+    IInputStream()
+        : mDataEndianness(EEndian::SystemEndian)
+        , mpReadCursor(nullptr)
+        , mpReadLimit(nullptr)
+    {}
+
+private:
+    // Holds string view data that couldn't be returned straight from the read window
+    std::vector<char> mStringBuffer;
+
+    uint64 ReadVarIntSlow();
+
+    template<typename ValType>
+    inline ValType ReadValue()
+    {
+        ValType Val;
+
+        if (mpReadLimit - mpReadCursor >= (ptrdiff_t) sizeof(ValType))
+        {
+            memcpy(&Val, mpReadCursor, sizeof(ValType));
+            mpReadCursor += sizeof(ValType);
+        }
+        else
+            ReadBytes(&Val, sizeof(ValType));
+
+        return Val;
+    }
+
+    template<typename ValType>
+    inline ValType ReadSwappedValue()
+    {
+        ValType Val = ReadValue<ValType>();
+        if (mDataEndianness != EEndian::SystemEndian) SwapBytes(Val);
+        return Val;
+    }
+
+    template<typename ValType>
+    inline ValType PeekSwappedValue()
+    {
+        if (mpReadLimit - mpReadCursor >= (ptrdiff_t) sizeof(ValType))
+        {
+            ValType Val;
+            memcpy(&Val, mpReadCursor, sizeof(ValType));
+            if (mDataEndianness != EEndian::SystemEndian) SwapBytes(Val);
+            return Val;
+        }
+
+        ValType Val = ReadSwappedValue<ValType>();
+        Seek64(-(int64) sizeof(ValType), SEEK_CUR);
+        return Val;
+    }
+
 public:
     bool ReadBool();
-    int8 ReadByte();
-    int16 ReadShort();
-    int32 ReadLong();
-    int64 ReadLongLong();
-    float ReadFloat();
-    double ReadDouble();
+    inline int8 ReadByte()              { return ReadValue<int8>(); }
+    inline int16 ReadShort()            { return ReadSwappedValue<int16>(); }
+    inline int32 ReadLong()             { return ReadSwappedValue<int32>(); }
+    inline int64 ReadLongLong()         { return ReadSwappedValue<int64>(); }
+    inline float ReadFloat()            { return ReadSwappedValue<float>(); }
+    inline double ReadDouble()          { return ReadSwappedValue<double>(); }
+    inline int64 ReadSignedVarInt()     { return DecodeZigZag(ReadVarInt()); }
+
+    inline uint64 ReadVarInt()
+    {
+        // Fast path: decode straight out of the read window
+        uint64 Val;
+
+        if (mpReadLimit - mpReadCursor >= 8)
+        {
+            uint32 Length = DecodeVarIntWord(mpReadCursor, Val);
+
+            if (Length)
+            {
+                mpReadCursor += Length;
+                return Val;
+            }
+        }
+
+        return ReadVarIntSlow();
+    }
+
     uint32 ReadFourCC();
     TString ReadString();
     TString ReadString(uint32 Count);
     TString ReadSizedString();
+
+    /**
+     * Read strings without building a TString. If the stream is memory-backed and the whole string
+     * is in its data, the view points directly into the data and stays valid for as long as the
+     * stream does. Otherwise the view is only valid until the next read from the stream. That
+     * includes strings cut off by the end of a memory-backed stream, which are gathered into a
+     * scratch buffer that the next string view read reuses.
+     */
+    CStringView ReadStringView();
+    CStringView ReadSizedStringView();
     T16String Read16String();
     T16String Read16String(uint32 Count);
     T16String ReadSized16String();
 
+    // Read Count elements in one block and byte swap them in bulk if needed
+    void ReadArray(int16 *pDst, uint32 Count);
+    void ReadArray(int32 *pDst, uint32 Count);
+    void ReadArray(int64 *pDst, uint32 Count);
+    void ReadArray(float *pDst, uint32 Count);
+    void ReadArray(double *pDst, uint32 Count);
+
     int8 PeekByte();
-    int16 PeekShort();
-    int32 PeekLong();
-    int64 PeekLongLong();
-    float PeekFloat();
-    double PeekDouble();
+    inline int16 PeekShort()            { return PeekSwappedValue<int16>(); }
+    inline int32 PeekLong()             { return PeekSwappedValue<int32>(); }
+    inline int64 PeekLongLong()         { return PeekSwappedValue<int64>(); }
+    inline float PeekFloat()            { return PeekSwappedValue<float>(); }
+    inline double PeekDouble()          { return PeekSwappedValue<double>(); }
     uint32 PeekFourCC();
 
-    bool GoTo(uint32 Address);
-    bool Skip(int32 SkipAmount);
+    bool GoTo(uint64 Address);
+    bool Skip(int64 SkipAmount);
 
     void SeekToBoundary(uint32 Boundary);
     void SetEndianness(EEndian Endianness);
@@ -45,15 +145,22 @@ public:
     EEndian GetEndianness() const;
     TString GetSourceString() const;
 
+    // 32-bit shorthands; use the 64-bit versions for anything that may be larger than 4 GiB
+    inline bool Seek(int32 Offset, uint32 Origin)   { return Seek64(Offset, Origin); }
+    inline uint32 Tell() const                      { return (uint32) Tell64(); }
+    inline uint32 Size() const                      { return (uint32) Size64(); }
+
     virtual ~IInputStream();
     virtual void ReadBytes(void *pDst, uint32 Count) = 0;
-    virtual bool Seek(int32 Offset, uint32 Origin) = 0;
-    virtual bool Seek64(int64 Offset, uint32 Origin);
-    virtual uint32 Tell() const = 0;
-    virtual uint64 Tell64() const;
+    virtual bool Seek64(int64 Offset, uint32 Origin) = 0;
+    virtual uint64 Tell64() const = 0;
     virtual bool EoF() const = 0;
     virtual bool IsValid() const = 0;
-    virtual uint32 Size() const = 0;
+    virtual uint64 Size64() const = 0;
+
+    // Memory-backed streams keep their entire contents in memory and expose it through Data()
+    virtual bool IsMemoryBacked() const;
+    virtual const void* Data() const;
 };
 
 #endif // IINPUTSTREAM_H
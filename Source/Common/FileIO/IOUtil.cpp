@@ -1,65 +1,98 @@
 #include "IOUtil.h"
 
-void SwapBytes(int16& rVal)
-{
-    rVal = (((rVal & 0x00FF) << 8) |
-           ((rVal & 0xFF00) >> 8));
-}
+#if __AVX2__
+#include <immintrin.h>
+#define USE_AVX2 1
+#elif __SSE2__ || _M_X64 || (_M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define USE_SSE2 1
+#endif
 
-void SwapBytes(uint16& rVal)
+/**
+ * Each function swaps as many elements as it can with vector registers and finishes the
+ * remainder with scalar swaps. Unaligned loads/stores are used throughout since stream
+ * buffers have no alignment guarantees.
+ */
+void SwapBytesArray(uint16 *pData, uint32 Count)
 {
-    rVal = (((rVal & 0x00FF) << 8) |
-           ((rVal & 0xFF00) >> 8));
-}
+    uint32 Idx = 0;
 
-void SwapBytes(int32& rVal)
-{
-    rVal = (((rVal & 0x000000FF) << 24) |
-           ((rVal & 0x0000FF00) <<  8) |
-           ((rVal & 0x00FF0000) >>  8) |
-           ((rVal & 0xFF000000) >> 24));
-}
+#if USE_AVX2
+    const __m256i kMask = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                                           1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
 
-void SwapBytes(uint32& rVal)
-{
-    rVal = (((rVal & 0x000000FF) << 24) |
-           ((rVal & 0x0000FF00) <<  8) |
-           ((rVal & 0x00FF0000) >>  8) |
-           ((rVal & 0xFF000000) >> 24));
-}
+    for (; Idx + 16 <= Count; Idx += 16)
+    {
+        __m256i Vec = _mm256_loadu_si256((const __m256i*) &pData[Idx]);
+        _mm256_storeu_si256((__m256i*) &pData[Idx], _mm256_shuffle_epi8(Vec, kMask));
+    }
+#elif USE_SSE2
+    for (; Idx + 8 <= Count; Idx += 8)
+    {
+        __m128i Vec = _mm_loadu_si128((const __m128i*) &pData[Idx]);
+        Vec = _mm_or_si128(_mm_slli_epi16(Vec, 8), _mm_srli_epi16(Vec, 8));
+        _mm_storeu_si128((__m128i*) &pData[Idx], Vec);
+    }
+#endif
 
-void SwapBytes(int64& rVal)
-{
-    rVal = (((rVal & 0x00000000000000FF) << 56) |
-           ((rVal & 0x000000000000FF00) << 40) |
-           ((rVal & 0x0000000000FF0000) << 24) |
-           ((rVal & 0x00000000FF000000) <<  8) |
-           ((rVal & 0x000000FF00000000) >>  8) |
-           ((rVal & 0x0000FF0000000000) >> 24) |
-           ((rVal & 0x00FF000000000000) >> 40) |
-           ((rVal & 0xFF00000000000000) >> 56));
+    for (; Idx < Count; Idx++)
+        SwapBytes(pData[Idx]);
 }
 
-void SwapBytes(uint64& rVal)
+void SwapBytesArray(uint32 *pData, uint32 Count)
 {
-    rVal = (((rVal & 0x00000000000000FF) << 56) |
-           ((rVal & 0x000000000000FF00) << 40) |
-           ((rVal & 0x0000000000FF0000) << 24) |
-           ((rVal & 0x00000000FF000000) <<  8) |
-           ((rVal & 0x000000FF00000000) >>  8) |
-           ((rVal & 0x0000FF0000000000) >> 24) |
-           ((rVal & 0x00FF000000000000) >> 40) |
-           ((rVal & 0xFF00000000000000) >> 56));
-}
+    uint32 Idx = 0;
 
-void SwapBytes(float& rVal)
-{
-    uint32* pPtr = (uint32*) &rVal;
-    SwapBytes(*pPtr);
+#if USE_AVX2
+    const __m256i kMask = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                           3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+    for (; Idx + 8 <= Count; Idx += 8)
+    {
+        __m256i Vec = _mm256_loadu_si256((const __m256i*) &pData[Idx]);
+        _mm256_storeu_si256((__m256i*) &pData[Idx], _mm256_shuffle_epi8(Vec, kMask));
+    }
+#elif USE_SSE2
+    // No byte shuffle in SSE2; swap the 16-bit halves of each element, then the bytes within each half
+    for (; Idx + 4 <= Count; Idx += 4)
+    {
+        __m128i Vec = _mm_loadu_si128((const __m128i*) &pData[Idx]);
+        Vec = _mm_shufflelo_epi16(Vec, _MM_SHUFFLE(2, 3, 0, 1));
+        Vec = _mm_shufflehi_epi16(Vec, _MM_SHUFFLE(2, 3, 0, 1));
+        Vec = _mm_or_si128(_mm_slli_epi16(Vec, 8), _mm_srli_epi16(Vec, 8));
+        _mm_storeu_si128((__m128i*) &pData[Idx], Vec);
+    }
+#endif
+
+    for (; Idx < Count; Idx++)
+        SwapBytes(pData[Idx]);
 }
 
-void SwapBytes(double& rVal)
+void SwapBytesArray(uint64 *pData, uint32 Count)
 {
-    uint64* pPtr = (uint64*) &rVal;
-    SwapBytes(*pPtr);
+    uint32 Idx = 0;
+
+#if USE_AVX2
+    const __m256i kMask = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                                           7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+
+    for (; Idx + 4 <= Count; Idx += 4)
+    {
+        __m256i Vec = _mm256_loadu_si256((const __m256i*) &pData[Idx]);
+        _mm256_storeu_si256((__m256i*) &pData[Idx], _mm256_shuffle_epi8(Vec, kMask));
+    }
+#elif USE_SSE2
+    // Reverse the 16-bit words of each element, then the bytes within each word
+    for (; Idx + 2 <= Count; Idx += 2)
+    {
+        __m128i Vec = _mm_loadu_si128((const __m128i*) &pData[Idx]);
+        Vec = _mm_shufflelo_epi16(Vec, _MM_SHUFFLE(0, 1, 2, 3));
+        Vec = _mm_shufflehi_epi16(Vec, _MM_SHUFFLE(0, 1, 2, 3));
+        Vec = _mm_or_si128(_mm_slli_epi16(Vec, 8), _mm_srli_epi16(Vec, 8));
+        _mm_storeu_si128((__m128i*) &pData[Idx], Vec);
+    }
+#endif
+
+    for (; Idx < Count; Idx++)
+        SwapBytes(pData[Idx]);
 }
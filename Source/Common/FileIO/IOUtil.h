@@ -2,6 +2,12 @@
 #define IOUTIL_H
 
 #include "Common/BasicTypes.h"
+#include <string.h>
+
+#if _MSC_VER
+#include <stdlib.h>
+#include <intrin.h>
+#endif
 
 enum class EEndian
 {
@@ -11,13 +17,116 @@ enum class EEndian
     SystemEndian = EEndian::LittleEndian
 };
 
-void SwapBytes(int16& rVal);
-void SwapBytes(uint16& rVal);
-void SwapBytes(int32& rVal);
-void SwapBytes(uint32& rVal);
-void SwapBytes(int64& rVal);
-void SwapBytes(uint64& rVal);
-void SwapBytes(float& rVal);
-void SwapBytes(double& rVal);
+// Byte swaps are inline and map to a single bswap instruction so they can be used in stream fast paths
+inline void SwapBytes(uint16& rVal)
+{
+#if _MSC_VER
+    rVal = _byteswap_ushort(rVal);
+#else
+    rVal = __builtin_bswap16(rVal);
+#endif
+}
+
+inline void SwapBytes(uint32& rVal)
+{
+#if _MSC_VER
+    rVal = _byteswap_ulong(rVal);
+#else
+    rVal = __builtin_bswap32(rVal);
+#endif
+}
+
+inline void SwapBytes(uint64& rVal)
+{
+#if _MSC_VER
+    rVal = _byteswap_uint64(rVal);
+#else
+    rVal = __builtin_bswap64(rVal);
+#endif
+}
+
+inline void SwapBytes(int16& rVal)  { SwapBytes((uint16&) rVal); }
+inline void SwapBytes(int32& rVal)  { SwapBytes((uint32&) rVal); }
+inline void SwapBytes(int64& rVal)  { SwapBytes((uint64&) rVal); }
+
+inline void SwapBytes(float& rVal)
+{
+    uint32 Bits;
+    memcpy(&Bits, &rVal, 4);
+    SwapBytes(Bits);
+    memcpy(&rVal, &Bits, 4);
+}
+
+inline void SwapBytes(double& rVal)
+{
+    uint64 Bits;
+    memcpy(&Bits, &rVal, 8);
+    SwapBytes(Bits);
+    memcpy(&rVal, &Bits, 8);
+}
+
+// Swap every element of an array in place; vectorized with SSE2/AVX2 where available
+void SwapBytesArray(uint16 *pData, uint32 Count);
+void SwapBytesArray(uint32 *pData, uint32 Count);
+void SwapBytesArray(uint64 *pData, uint32 Count);
+
+inline void SwapBytesArray(int16 *pData, uint32 Count)  { SwapBytesArray((uint16*) pData, Count); }
+inline void SwapBytesArray(int32 *pData, uint32 Count)  { SwapBytesArray((uint32*) pData, Count); }
+inline void SwapBytesArray(int64 *pData, uint32 Count)  { SwapBytesArray((uint64*) pData, Count); }
+inline void SwapBytesArray(float *pData, uint32 Count)  { SwapBytesArray((uint32*) pData, Count); }
+inline void SwapBytesArray(double *pData, uint32 Count) { SwapBytesArray((uint64*) pData, Count); }
+
+// LEB128 variable-length integers: 7 bits per byte, low bits first, with the high bit set on every byte but the last
+const uint32 gkMaxVarIntSize = 10;
+
+inline uint32 EncodeVarInt(uint64 Val, uint8 *pOut)
+{
+    uint32 Size = 0;
+
+    while (Val >= 0x80)
+    {
+        pOut[Size++] = (uint8) (Val | 0x80);
+        Val >>= 7;
+    }
+
+    pOut[Size++] = (uint8) Val;
+    return Size;
+}
+
+/**
+ * Decodes a varint of up to 8 bytes from an 8-byte word without looping over bytes. The end of the
+ * varint is the first byte with a clear high bit; the 7-bit groups before it are then packed together
+ * with three mask-and-shift steps. Returns the encoded length, or 0 if the varint is longer than 8 bytes.
+ * pkData must have at least 8 readable bytes.
+ */
+inline uint32 DecodeVarIntWord(const uint8 *pkData, uint64& rOutVal)
+{
+    uint64 Word;
+    memcpy(&Word, pkData, 8);
+    uint64 StopBits = ~Word & 0x8080808080808080ULL;
+    if (StopBits == 0) return 0;
+
+#if _MSC_VER
+    unsigned long StopBit;
+    _BitScanForward64(&StopBit, StopBits);
+#else
+    uint32 StopBit = (uint32) __builtin_ctzll(StopBits);
+#endif
+
+    // Drop the bytes after the varint, then the continuation bits, then close the gaps
+    uint32 Length = (StopBit >> 3) + 1;
+    if (Length < 8) Word &= (1ULL << (Length * 8)) - 1;
+    Word &= 0x7F7F7F7F7F7F7F7FULL;
+    Word = (Word & 0x007F007F007F007FULL) | ((Word & 0x7F007F007F007F00ULL) >> 1);
+    Word = (Word & 0x00003FFF00003FFFULL) | ((Word & 0x3FFF00003FFF0000ULL) >> 2);
+    Word = (Word & 0x000000000FFFFFFFULL) | ((Word & 0x0FFFFFFF00000000ULL) >> 4);
+
+    rOutVal = Word;
+    return Length;
+}
+
+// Zigzag encoding maps signed values of small magnitude to small unsigned values: 0, -1, 1, -2... -> 0, 1, 2, 3...
+inline uint64 EncodeZigZag(int64 Val)   { return ((uint64) Val << 1) ^ (uint64) (Val >> 63); }
+inline int64 DecodeZigZag(uint64 Val)   { return (int64) (Val >> 1) ^ -(int64) (Val & 1); }
 
 #endif // IOUTIL_H
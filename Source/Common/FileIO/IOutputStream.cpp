@@ -45,6 +45,13 @@ void IOutputStream::WriteDouble(double Val)
     WriteBytes(&Val, 8);
 }
 
+void IOutputStream::WriteVarInt(uint64 Val)
+{
+    uint8 Bytes[gkMaxVarIntSize];
+    uint32 Size = EncodeVarInt(Val, Bytes);
+    WriteBytes(Bytes, Size);
+}
+
 void IOutputStream::WriteFourCC(uint32 Val)
 {
     if (EEndian::SystemEndian == EEndian::LittleEndian) SwapBytes(Val);
@@ -88,19 +95,44 @@ void IOutputStream::WriteSized16String(const T16String& rkVal)
         WriteShort(rkVal[ChrIdx]);
 }
 
-bool IOutputStream::GoTo(uint32 Address)
+void IOutputStream::WriteArray(const int16 *pkSrc, uint32 Count)
+{
+    WriteSwappedArray(pkSrc, Count);
+}
+
+void IOutputStream::WriteArray(const int32 *pkSrc, uint32 Count)
 {
-    return Seek(Address, SEEK_SET);
+    WriteSwappedArray(pkSrc, Count);
 }
 
-bool IOutputStream::Skip(int32 SkipAmount)
+void IOutputStream::WriteArray(const int64 *pkSrc, uint32 Count)
 {
-    return Seek(SkipAmount, SEEK_CUR);
+    WriteSwappedArray(pkSrc, Count);
+}
+
+void IOutputStream::WriteArray(const float *pkSrc, uint32 Count)
+{
+    WriteSwappedArray(pkSrc, Count);
+}
+
+void IOutputStream::WriteArray(const double *pkSrc, uint32 Count)
+{
+    WriteSwappedArray(pkSrc, Count);
+}
+
+bool IOutputStream::GoTo(uint64 Address)
+{
+    return Seek64(Address, SEEK_SET);
+}
+
+bool IOutputStream::Skip(int64 SkipAmount)
+{
+    return Seek64(SkipAmount, SEEK_CUR);
 }
 
 void IOutputStream::WriteToBoundary(uint32 Boundary, uint8 Fill)
 {
-    uint32 Num = Boundary - (Tell() % Boundary);
+    uint32 Num = Boundary - (uint32) (Tell64() % Boundary);
     if (Num == Boundary) return;
     for (uint32 iByte = 0; iByte < Num; iByte++)
         WriteByte(Fill);
@@ -126,12 +158,34 @@ TString IOutputStream::GetDestString() const
     return mDataDest;
 }
 
-bool IOutputStream::Seek64(int64 Offset, uint32 Origin)
+void IOutputStream::WriteSegments(const SWriteSegment *pkSegments, uint32 NumSegments)
 {
-    return Seek((int32) Offset, Origin);
+    for (uint32 SegIdx = 0; SegIdx < NumSegments; SegIdx++)
+        WriteBytes(pkSegments[SegIdx].pkData, pkSegments[SegIdx].Size);
 }
 
-uint64 IOutputStream::Tell64() const
+// ************ PRIVATE ************
+template<typename ValType>
+void IOutputStream::WriteSwappedArray(const ValType *pkSrc, uint32 Count)
 {
-    return (uint64) (Tell());
+    if (mDataEndianness == EEndian::SystemEndian)
+    {
+        WriteBytes(pkSrc, Count * sizeof(ValType));
+        return;
+    }
+
+    // Swap through a stack buffer so the caller's data is left untouched
+    const uint32 kChunkCount = 0x1000 / sizeof(ValType);
+    ValType Chunk[kChunkCount];
+
+    while (Count > 0)
+    {
+        uint32 NumElems = (Count < kChunkCount ? Count : kChunkCount);
+        memcpy(Chunk, pkSrc, NumElems * sizeof(ValType));
+        SwapBytesArray(Chunk, NumElems);
+        WriteBytes(Chunk, NumElems * sizeof(ValType));
+
+        pkSrc += NumElems;
+        Count -= NumElems;
+    }
 }
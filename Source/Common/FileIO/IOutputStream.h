@@ -4,12 +4,23 @@
 #include "IOUtil.h"
 #include "Common/TString.h"
 
+/** One block of data for IOutputStream::WriteSegments */
+struct SWriteSegment
+{
+    const void *pkData;
+    uint32 Size;
+};
+
 class IOutputStream
 {
 protected:
     EEndian mDataEndianness;
     TString mDataDest;
 
+private:
+    template<typename ValType>
+    void WriteSwappedArray(const ValType *pkSrc, uint32 Count);
+
 public:
     void WriteBool(bool Val);
     void WriteByte(int8 Val);
@@ -18,14 +29,23 @@ public:
     void WriteLongLong(int64 Val);
     void WriteFloat(float Val);
     void WriteDouble(double Val);
+    void WriteVarInt(uint64 Val);
+    inline void WriteSignedVarInt(int64 Val)    { WriteVarInt(EncodeZigZag(Val)); }
     void WriteFourCC(uint32 Val);
     void WriteString(const TString& rkVal, int Count = -1, bool Terminate = true);
     void WriteSizedString(const TString& rkVal);
     void Write16String(const T16String& rkVal, int Count = -1, bool Terminate = true);
     void WriteSized16String(const T16String& rkVal);
 
-    bool GoTo(uint32 Address);
-    bool Skip(int32 SkipAmount);
+    // Write Count elements in one block, byte swapping them in bulk if needed
+    void WriteArray(const int16 *pkSrc, uint32 Count);
+    void WriteArray(const int32 *pkSrc, uint32 Count);
+    void WriteArray(const int64 *pkSrc, uint32 Count);
+    void WriteArray(const float *pkSrc, uint32 Count);
+    void WriteArray(const double *pkSrc, uint32 Count);
+
+    bool GoTo(uint64 Address);
+    bool Skip(int64 SkipAmount);
 
     void WriteToBoundary(uint32 Boundary, uint8 Fill);
     void SetEndianness(EEndian Endianness);
@@ -33,14 +53,20 @@ public:
     EEndian GetEndianness() const;
     TString GetDestString() const;
 
+    // 32-bit shorthands; use the 64-bit versions for anything that may be larger than 4 GiB
+    inline bool Seek(int32 Offset, uint32 Origin)   { return Seek64(Offset, Origin); }
+    inline uint32 Tell() const                      { return (uint32) Tell64(); }
+    inline uint32 Size() const                      { return (uint32) Size64(); }
+
     virtual ~IOutputStream();
     virtual void WriteBytes(const void *pkSrc, uint32 Count) = 0;
-    virtual bool Seek(int32 Offset, uint32 Origin) = 0;
-    virtual bool Seek64(int64 Offset, uint32 Origin);
-    virtual uint32 Tell() const = 0;
-    virtual uint64 Tell64() const;
+    virtual bool Seek64(int64 Offset, uint32 Origin) = 0;
+    virtual uint64 Tell64() const = 0;
     virtual bool EoF() const = 0;
     virtual bool IsValid() const = 0;
-    virtual uint32 Size() const = 0;
+    virtual uint64 Size64() const = 0;
+
+    // Write a batch of blocks back-to-back. Streams can override this to avoid staging them one by one.
+    virtual void WriteSegments(const SWriteSegment *pkSegments, uint32 NumSegments);
 };
 #endif // COUTPUTSTREAM_H
@@ -1,6 +1,6 @@
 #include "FileUtil.h"
 #include "Macros.h"
-#include "Common/FileIO/CFileInStream.h"
+#include "Common/FileIO/CMappedFileInStream.h"
 
 #include <experimental/filesystem>
 #include <system_error>
@@ -514,12 +514,11 @@ TString FindFileExtension(const TString& rkDir, const TString& rkName)
 
 bool LoadFileToString(const TString& rkFilePath, TString& rOut)
 {
-    CFileInStream File(rkFilePath);
+    CMappedFileInStream File(rkFilePath);
 
     if (File.IsValid())
     {
-        rOut = TString(File.Size());
-        File.ReadBytes(&rOut[0], rOut.Size());
+        rOut = (File.Size() > 0 ? TString((const char*) File.Data(), File.Size()) : TString());
         return true;
     }
     else
@@ -3,6 +3,27 @@
 
 #include "Common/BasicTypes.h"
 
+/** CRC32 lookup table. Generated at compile time so hashes can be evaluated in constant expressions. */
+struct SCRC32Table
+{
+    uint32 Entries[256];
+
+    constexpr SCRC32Table()
+        : Entries()
+    {
+        for (uint32 Idx = 0; Idx < 256; Idx++)
+        {
+            uint32 Value = Idx;
+
+            for (uint32 Bit = 0; Bit < 8; Bit++)
+                Value = (Value & 1) ? (Value >> 1) ^ 0xEDB88320 : (Value >> 1);
+
+            Entries[Idx] = Value;
+        }
+    }
+};
+inline constexpr SCRC32Table gkCRC32Table;
+
 /**
  * CRC32 hash implementation
  */
@@ -34,7 +55,17 @@ public:
     void Hash(char v);
     void Hash(const char* pkString);
 
-    static uint32 StaticHashString(const char* pkString);
+    /** Hash a null-terminated string. Constexpr, so string literals can be hashed at compile time. */
+    static constexpr uint32 StaticHashString(const char* pkString)
+    {
+        uint32 Hash = 0xFFFFFFFF;
+
+        while (*pkString)
+            Hash = gkCRC32Table.Entries[(Hash ^ (uint8) *pkString++) & 0xFF] ^ (Hash >> 8);
+
+        return Hash;
+    }
+
     static uint32 StaticHashData(const void* pkData, uint Size);
 };
 
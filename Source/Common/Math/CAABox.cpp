@@ -24,8 +24,8 @@ CAABox::CAABox(IInputStream& rInput)
 
 void CAABox::Serialize(IArchive& rArc)
 {
-    rArc << SerialParameter("Min", mMin)
-         << SerialParameter("Max", mMax);
+    rArc << SerialParameter(SERIAL_NAME("Min"), mMin)
+         << SerialParameter(SERIAL_NAME("Max"), mMax);
 }
 
 void CAABox::Write(IOutputStream& rOutput)
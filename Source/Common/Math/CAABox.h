@@ -56,5 +56,6 @@ public:
     static const CAABox skOne;
     static const CAABox skZero;
 };
+DECLARE_BULK_SERIAL_TYPE(CAABox, float, 6)
 
 #endif // CAABOX_H
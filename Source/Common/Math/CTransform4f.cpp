@@ -73,9 +73,9 @@ CTransform4f::CTransform4f(CVector3f Position, CVector3f Rotation, CVector3f Sca
 
 void CTransform4f::Serialize(IArchive& rOut)
 {
-    rOut << SerialParameter("Row0Col0", m[0][0]) << SerialParameter("Row0Col1", m[0][1]) << SerialParameter("Row0Col2", m[0][2]) << SerialParameter("Row0Col3", m[0][3])
-         << SerialParameter("Row1Col0", m[1][0]) << SerialParameter("Row1Col1", m[1][1]) << SerialParameter("Row1Col2", m[1][2]) << SerialParameter("Row1Col3", m[1][3])
-         << SerialParameter("Row2Col0", m[2][0]) << SerialParameter("Row2Col1", m[2][1]) << SerialParameter("Row2Col2", m[2][2]) << SerialParameter("Row2Col3", m[2][3]);
+    rOut << SerialParameter(SERIAL_NAME("Row0Col0"), m[0][0]) << SerialParameter(SERIAL_NAME("Row0Col1"), m[0][1]) << SerialParameter(SERIAL_NAME("Row0Col2"), m[0][2]) << SerialParameter(SERIAL_NAME("Row0Col3"), m[0][3])
+         << SerialParameter(SERIAL_NAME("Row1Col0"), m[1][0]) << SerialParameter(SERIAL_NAME("Row1Col1"), m[1][1]) << SerialParameter(SERIAL_NAME("Row1Col2"), m[1][2]) << SerialParameter(SERIAL_NAME("Row1Col3"), m[1][3])
+         << SerialParameter(SERIAL_NAME("Row2Col0"), m[2][0]) << SerialParameter(SERIAL_NAME("Row2Col1"), m[2][1]) << SerialParameter(SERIAL_NAME("Row2Col2"), m[2][2]) << SerialParameter(SERIAL_NAME("Row2Col3"), m[2][3]);
 }
 
 void CTransform4f::Write(IOutputStream& rOut)
@@ -73,5 +73,6 @@ protected:
         m[3][3] = 1.f;
     }
 };
+DECLARE_BULK_SERIAL_TYPE(CTransform4f, float, 12)
 
 #endif // CTRANSFORM4F_H
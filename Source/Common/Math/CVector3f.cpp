@@ -38,9 +38,9 @@ void CVector3f::Write(IOutputStream& rOutput) const
 
 void CVector3f::Serialize(IArchive& rArc)
 {
-    rArc << SerialParameter("X", X)
-         << SerialParameter("Y", Y)
-         << SerialParameter("Z", Z);
+    rArc << SerialParameter(SERIAL_NAME("X"), X)
+         << SerialParameter(SERIAL_NAME("Y"), Y)
+         << SerialParameter(SERIAL_NAME("Z"), Z);
 }
 
 TString CVector3f::ToString() const
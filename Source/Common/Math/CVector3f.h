@@ -91,5 +91,6 @@ public:
     // Other
     friend std::ostream& operator<<(std::ostream& rOut, const CVector3f& rkVector);
 };
+DECLARE_BULK_SERIAL_TYPE(CVector3f, float, 3)
 
 #endif // CVECTOR3F_H
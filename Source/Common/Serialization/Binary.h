@@ -3,3 +3,5 @@
 #include "CBinaryWriter.h"
 #include "CBasicBinaryReader.h"
 #include "CBasicBinaryWriter.h"
+#include "CBinaryTreeReader.h"
+#include "CBinaryTreeWriter.h"
@@ -0,0 +1,58 @@
+#ifndef BINARYCOMMON_H
+#define BINARYCOMMON_H
+
+#include "Common/BasicTypes.h"
+
+/** EBinaryArchiveFlags - Format flags for CBinaryReader/CBinaryWriter archives.
+ *  They're stored inverted in the root parameter ID. Older files always have 0xFFFFFFFF there,
+ *  so they read as having no flags set.
+ */
+enum EBinaryArchiveFlags
+{
+    BAF_64BitSizes          = 0x1,      // Parameter sizes are 64-bit. Required for archives larger than 4 GiB.
+    BAF_VarInts             = 0x2,      // Parameter sizes, child counts and 16-64 bit integers are LEB128 varints; signed integers are zigzag encoded.
+                                        // Param IDs, asset IDs, floats and bulk scalar arrays stay fixed-size.
+    BAF_RootTrailer         = 0x4,      // The root's size is left as 0 and its child count is a uint32 at the very end of the archive,
+                                        // so top-level params can be written out as soon as they're finished. The archive must run to
+                                        // the end of the stream it's read from.
+};
+
+/** EBinaryWriteMode - How CBinaryWriter gets parameter sizes and child counts into the output. */
+enum class EBinaryWriteMode
+{
+    Patch,      // Fillers are patched in place in the output stream when each parameter ends. Needs a seekable stream.
+    Streaming   // Each top-level parameter is built in memory (a segmented arena, or a contiguous buffer with BAF_VarInts), and sent
+                // to the output in one forward-only write once it's finished. Memory use is the size of the largest top-level parameter,
+                // so archives with one huge top-level parameter still get buffered whole. Sets BAF_RootTrailer.
+};
+
+/** EBinaryTreeType - Type tags for parameters in CBinaryTreeReader/CBinaryTreeWriter archives.
+ *  Values are stored as written; readers convert between numeric types as needed.
+ */
+enum class EBinaryTreeType : uint8
+{
+    Empty,          // Parameter has no value or children
+    Compound,       // Parameter has child parameters. A value alongside them is stored in a child with an empty name.
+    Bool,
+    Int8,
+    UInt8,
+    Int16,
+    UInt16,
+    Int32,
+    UInt32,
+    Int64,
+    UInt64,
+    Float,
+    Double,
+    String,         // Varint length followed by the characters
+    FourCC,
+    AssetID,        // 32 or 64 bits, depending on the payload size
+    Bytes,
+    Int16Array,
+    Int32Array,
+    Int64Array,
+    FloatArray,
+    DoubleArray
+};
+
+#endif // BINARYCOMMON_H
@@ -20,8 +20,8 @@ public:
         : IArchive()
         , mOwnsStream(true)
     {
-        mArchiveFlags = AF_Binary | AF_Reader | AF_NoSkipping;
-        mpStream = new CFileInStream(rkFilename, EEndian::BigEndian);
+        mArchiveFlags = AF_Binary | AF_Reader | AF_NoSkipping | AF_BulkScalars;
+        mpStream = new CMappedFileInStream(rkFilename, EEndian::BigEndian);
 
         if (mpStream->IsValid())
         {
@@ -35,7 +35,7 @@ public:
         , mMagicValid(true)
         , mOwnsStream(false)
     {
-        mArchiveFlags = AF_Binary | AF_Reader | AF_NoSkipping;
+        mArchiveFlags = AF_Binary | AF_Reader | AF_NoSkipping | AF_BulkScalars;
 
         ASSERT(pStream->IsValid());
         mpStream = pStream;
@@ -47,7 +47,7 @@ public:
         , mMagicValid(true)
         , mOwnsStream(true)
     {
-        mArchiveFlags = AF_Binary | AF_Reader | AF_NoSkipping;
+        mArchiveFlags = AF_Binary | AF_Reader | AF_NoSkipping | AF_BulkScalars;
         mpStream = new CMemoryInStream(pData, DataSize, Endian);
         SetVersion(rkVersion);
     }
@@ -70,6 +70,11 @@ public:
     virtual bool PreSerializePointer(void*& Pointer, uint32 Flags)                      { return ArchiveVersion() >= eArVer_Refactor ? mpStream->ReadBool() : true; }
     virtual void SerializeContainerSize(uint32& rSize, const TString&, uint32 Flags)    { SerializePrimitive(rSize, Flags); }
     virtual void SerializeBulkData(void* pData, uint32 Size, uint32 Flags)              { mpStream->ReadBytes(pData, Size); }
+    virtual void SerializeBulkScalars(int16* pData, uint32 Count, uint32 Flags)         { mpStream->ReadArray(pData, Count); }
+    virtual void SerializeBulkScalars(int32* pData, uint32 Count, uint32 Flags)         { mpStream->ReadArray(pData, Count); }
+    virtual void SerializeBulkScalars(int64* pData, uint32 Count, uint32 Flags)         { mpStream->ReadArray(pData, Count); }
+    virtual void SerializeBulkScalars(float* pData, uint32 Count, uint32 Flags)         { mpStream->ReadArray(pData, Count); }
+    virtual void SerializeBulkScalars(double* pData, uint32 Count, uint32 Flags)        { mpStream->ReadArray(pData, Count); }
 
     virtual void SerializePrimitive(bool& rValue, uint32 Flags)         { rValue = mpStream->ReadBool(); }
     virtual void SerializePrimitive(char& rValue, uint32 Flags)         { rValue = mpStream->ReadByte(); }
@@ -20,7 +20,7 @@ public:
         , mMagic(Magic)
         , mOwnsStream(true)
     {
-        mArchiveFlags = AF_Binary | AF_Writer | AF_NoSkipping;
+        mArchiveFlags = AF_Binary | AF_Writer | AF_NoSkipping | AF_BulkScalars;
         mpStream = new CFileOutStream(rkFilename, EEndian::BigEndian);
 
         if (mpStream->IsValid())
@@ -36,7 +36,7 @@ public:
         , mOwnsStream(false)
     {
         ASSERT(pStream->IsValid());
-        mArchiveFlags = AF_Binary | AF_Writer | AF_NoSkipping;
+        mArchiveFlags = AF_Binary | AF_Writer | AF_NoSkipping | AF_BulkScalars;
         mpStream = pStream;
         SetVersion(skCurrentArchiveVersion, FileVersion, Game);
     }
@@ -46,7 +46,7 @@ public:
         , mOwnsStream(false)
     {
         ASSERT(pStream->IsValid());
-        mArchiveFlags = AF_Binary | AF_Writer | AF_NoSkipping;
+        mArchiveFlags = AF_Binary | AF_Writer | AF_NoSkipping | AF_BulkScalars;
         mpStream = pStream;
         SetVersion(rkVersion);
     }
@@ -97,6 +97,11 @@ public:
     virtual void SerializePrimitive(CFourCC& rValue, uint32 Flags)          { rValue.Write(*mpStream); }
     virtual void SerializePrimitive(CAssetID& rValue, uint32 Flags)         { rValue.Write(*mpStream, CAssetID::GameIDLength(Game())); }
     virtual void SerializeBulkData(void* pData, uint32 Size, uint32 Flags)  { mpStream->WriteBytes(pData, Size); }
+    virtual void SerializeBulkScalars(int16* pData, uint32 Count, uint32 Flags)     { mpStream->WriteArray(pData, Count); }
+    virtual void SerializeBulkScalars(int32* pData, uint32 Count, uint32 Flags)     { mpStream->WriteArray(pData, Count); }
+    virtual void SerializeBulkScalars(int64* pData, uint32 Count, uint32 Flags)     { mpStream->WriteArray(pData, Count); }
+    virtual void SerializeBulkScalars(float* pData, uint32 Count, uint32 Flags)     { mpStream->WriteArray(pData, Count); }
+    virtual void SerializeBulkScalars(double* pData, uint32 Count, uint32 Flags)    { mpStream->WriteArray(pData, Count); }
 };
 
 #endif // CBASICBINARYWRITER
@@ -2,21 +2,35 @@
 #define CBINARYREADER
 
 #include "IArchive.h"
+#include "BinaryCommon.h"
 #include "CSerialVersion.h"
 #include "Common/CFourCC.h"
+#include <unordered_map>
 
 class CBinaryReader : public IArchive
 {
     struct SBinaryParm
     {
-        uint32 Offset;
-        uint32 Size;
+        uint64 Offset;
+        uint64 Size;
         uint32 NumChildren;
         uint32 ChildIndex;
+        bool HasChildMap;
     };
     std::vector<SBinaryParm> mBinaryParmStack;
 
+    // Per-parent lookup from param ID to child, built the first time a parent's next child
+    // doesn't match the requested param. Indexed by stack depth and reused between parents.
+    struct SChildEntry
+    {
+        uint64 Offset;
+        uint64 Size;
+        uint32 Index;
+    };
+    std::vector< std::unordered_map<uint32, SChildEntry> > mChildMaps;
+
     IInputStream *mpStream;
+    uint32 mFormatFlags;
     bool mMagicValid;
     bool mOwnsStream;
     bool mInAttribute;
@@ -24,11 +38,12 @@ class CBinaryReader : public IArchive
 public:
     CBinaryReader(const TString& rkFilename, uint32 Magic)
         : IArchive()
+        , mFormatFlags(0)
         , mOwnsStream(true)
         , mInAttribute(false)
     {
         mArchiveFlags = AF_Reader | AF_Binary;
-        mpStream = new CFileInStream(rkFilename, EEndian::BigEndian);
+        mpStream = new CMappedFileInStream(rkFilename, EEndian::BigEndian);
 
         if (mpStream->IsValid())
         {
@@ -41,6 +56,7 @@ public:
 
     CBinaryReader(IInputStream *pStream, const CSerialVersion& rkVersion)
         : IArchive()
+        , mFormatFlags(0)
         , mMagicValid(true)
         , mOwnsStream(false)
         , mInAttribute(false)
@@ -63,67 +79,123 @@ public:
 private:
     void InitParamStack()
     {
-        mpStream->Skip(4); // Skip root ID (which is always -1)
-        uint32 Size = ReadSize();
-        uint32 Offset = mpStream->Tell();
-        uint32 NumChildren = ReadSize();
-        mBinaryParmStack.push_back( SBinaryParm { Offset, Size, NumChildren, 0 } );
+        // The root ID holds the format flags
+        mFormatFlags = ~((uint32) mpStream->ReadLong());
+        uint64 Size = ReadSize();
+        uint64 Offset = mpStream->Tell64();
+        uint32 NumChildren;
+
+        if (mFormatFlags & BAF_RootTrailer)
+        {
+            // The child count is at the end of the stream, and the children run up to it
+            mpStream->GoTo(mpStream->Size64() - 4);
+            NumChildren = mpStream->ReadLong();
+            Size = mpStream->Size64() - 4 - Offset;
+            mpStream->GoTo(Offset);
+        }
+        else
+            NumChildren = ReadCount();
+
+        mBinaryParmStack.push_back( SBinaryParm { Offset, Size, NumChildren, 0, false } );
         mBinaryParmStack.reserve(20);
     }
 
+    void BuildChildMap()
+    {
+        // Scan the parent's children once and record where each one is, so later lookups are O(1)
+        // instead of rescanning every sibling. The first child with a given ID wins, like a linear scan.
+        uint32 Depth = mBinaryParmStack.size() - 1;
+        SBinaryParm& rParent = mBinaryParmStack[Depth];
+
+        if (mChildMaps.size() <= Depth)
+            mChildMaps.resize(Depth + 1);
+
+        std::unordered_map<uint32, SChildEntry>& rChildMap = mChildMaps[Depth];
+        rChildMap.clear();
+        rChildMap.reserve(rParent.NumChildren);
+
+        // Children start after the parent's child count, unless it's in the root trailer
+        mpStream->GoTo(rParent.Offset);
+
+        if (Depth > 0 || !(mFormatFlags & BAF_RootTrailer))
+            ReadCount();
+
+        for (uint32 ChildIdx = 0; ChildIdx < rParent.NumChildren; ChildIdx++)
+        {
+            uint32 ChildID = mpStream->ReadLong();
+            uint64 ChildSize = ReadSize();
+            uint64 ChildOffset = mpStream->Tell64();
+            rChildMap.emplace(ChildID, SChildEntry { ChildOffset, ChildSize, ChildIdx });
+            mpStream->Skip(ChildSize);
+        }
+
+        rParent.HasChildMap = true;
+    }
+
 public:
     // Interface
-    uint32 ReadSize()
+    uint32 ReadCount()
     {
+        if (mFormatFlags & BAF_VarInts)
+            return (uint32) mpStream->ReadVarInt();
+
         return (mArchiveVersion < eArVer_32BitBinarySize ? (uint32) mpStream->ReadShort() : mpStream->ReadLong());
     }
 
+    uint64 ReadSize()
+    {
+        if (mFormatFlags & BAF_VarInts)
+            return mpStream->ReadVarInt();
+
+        return ((mFormatFlags & BAF_64BitSizes) ? (uint64) mpStream->ReadLongLong() : ReadCount());
+    }
+
     virtual bool ParamBegin(const char *pkName, uint32 Flags)
+    {
+        return ParamBegin(pkName, CCRC32::StaticHashString(pkName), Flags);
+    }
+
+    virtual bool ParamBegin(const char *pkName, uint32 ParamID, uint32 Flags)
     {
         // If this is the parent parameter's first child, then read the child count
         if (mBinaryParmStack.back().NumChildren == 0xFFFFFFFF)
         {
-            mBinaryParmStack.back().NumChildren = ReadSize();
+            mBinaryParmStack.back().NumChildren = ReadCount();
         }
 
         // Save current offset
-        uint32 Offset = mpStream->Tell();
-        uint32 ParamID = TString(pkName).Hash32();
+        uint64 Offset = mpStream->Tell64();
 
         // Check the next parameter ID first and check whether it's a match for the current parameter
         if (mBinaryParmStack.back().ChildIndex < mBinaryParmStack.back().NumChildren)
         {
             uint32 NextID = mpStream->ReadLong();
-            uint32 NextSize = ReadSize();
+            uint64 NextSize = ReadSize();
 
             // Does the next parameter ID match the current one?
             if (NextID == ParamID || (Flags & SH_IgnoreName))
             {
-                mBinaryParmStack.push_back( SBinaryParm { mpStream->Tell(), NextSize, 0xFFFFFFFF, 0 } );
+                mBinaryParmStack.push_back( SBinaryParm { mpStream->Tell64(), NextSize, 0xFFFFFFFF, 0, false } );
                 return true;
             }
         }
 
-        // It's not a match - return to the parent parameter's first child and check all children to find a match
+        // It's not a match - look the parameter up in the parent's child map, building it if needed
         if (!mBinaryParmStack.empty())
         {
-            uint32 ParentOffset = mBinaryParmStack.back().Offset;
-            uint32 NumChildren = mBinaryParmStack.back().NumChildren;
-            mpStream->GoTo(ParentOffset);
+            if (!mBinaryParmStack.back().HasChildMap)
+                BuildChildMap();
+
+            const std::unordered_map<uint32, SChildEntry>& rkChildMap = mChildMaps[mBinaryParmStack.size() - 1];
+            auto Iter = rkChildMap.find(ParamID);
 
-            for (uint32 ChildIdx = 0; ChildIdx < NumChildren; ChildIdx++)
+            if (Iter != rkChildMap.end())
             {
-                uint32 ChildID = mpStream->ReadLong();
-                uint32 ChildSize = ReadSize();
-
-                if (ChildID != ParamID)
-                    mpStream->Skip(ChildSize);
-                else
-                {
-                    mBinaryParmStack.back().ChildIndex = ChildIdx;
-                    mBinaryParmStack.push_back( SBinaryParm { mpStream->Tell(), ChildSize, 0xFFFFFFFF, 0 } );
-                    return true;
-                }
+                const SChildEntry& rkChild = Iter->second;
+                mBinaryParmStack.back().ChildIndex = rkChild.Index;
+                mpStream->GoTo(rkChild.Offset);
+                mBinaryParmStack.push_back( SBinaryParm { rkChild.Offset, rkChild.Size, 0xFFFFFFFF, 0, false } );
+                return true;
             }
         }
 
@@ -136,7 +208,7 @@ public:
     {
         // Make sure we're at the end of the parameter
         SBinaryParm& rParam = mBinaryParmStack.back();
-        uint32 EndOffset = rParam.Offset + rParam.Size;
+        uint64 EndOffset = rParam.Offset + rParam.Size;
         mpStream->GoTo(EndOffset);
         mBinaryParmStack.pop_back();
 
@@ -150,7 +222,7 @@ public:
         if (ArchiveVersion() >= eArVer_Refactor)
         {
             bool ValidPtr = (Pointer != nullptr);
-            *this << SerialParameter("PointerValid", ValidPtr);
+            *this << SerialParameter(SERIAL_NAME("PointerValid"), ValidPtr);
             return ValidPtr;
         }
         else
@@ -159,28 +231,55 @@ public:
         }
     }
 
-    virtual void SerializeContainerSize(uint32& rSize, const TString& /*rkElemName*/)
-    {
-        // Mostly handled by ParamBegin, we just need to return the size correctly so the container can be resized
-        rSize = (mArchiveVersion < eArVer_32BitBinarySize ? (uint32) mpStream->PeekShort() : mpStream->PeekLong());
-    }
-
     virtual void SerializePrimitive(bool& rValue, uint32 Flags)             { rValue = mpStream->ReadBool(); }
     virtual void SerializePrimitive(char& rValue, uint32 Flags)             { rValue = mpStream->ReadByte(); }
     virtual void SerializePrimitive(int8& rValue, uint32 Flags)             { rValue = mpStream->ReadByte(); }
     virtual void SerializePrimitive(uint8& rValue, uint32 Flags)            { rValue = mpStream->ReadByte(); }
-    virtual void SerializePrimitive(int16& rValue, uint32 Flags)            { rValue = mpStream->ReadShort(); }
-    virtual void SerializePrimitive(uint16& rValue, uint32 Flags)           { rValue = mpStream->ReadShort(); }
-    virtual void SerializePrimitive(int32& rValue, uint32 Flags)            { rValue = mpStream->ReadLong(); }
-    virtual void SerializePrimitive(uint32& rValue, uint32 Flags)           { rValue = mpStream->ReadLong(); }
-    virtual void SerializePrimitive(int64& rValue, uint32 Flags)            { rValue = mpStream->ReadLongLong(); }
-    virtual void SerializePrimitive(uint64& rValue, uint32 Flags)           { rValue = mpStream->ReadLongLong(); }
+    virtual void SerializePrimitive(int16& rValue, uint32 Flags)            { rValue = ReadInteger<int16>(); }
+    virtual void SerializePrimitive(uint16& rValue, uint32 Flags)           { rValue = ReadInteger<uint16>(); }
+    virtual void SerializePrimitive(int32& rValue, uint32 Flags)            { rValue = ReadInteger<int32>(); }
+    virtual void SerializePrimitive(uint32& rValue, uint32 Flags)           { rValue = ReadInteger<uint32>(); }
+    virtual void SerializePrimitive(int64& rValue, uint32 Flags)            { rValue = ReadInteger<int64>(); }
+    virtual void SerializePrimitive(uint64& rValue, uint32 Flags)           { rValue = ReadInteger<uint64>(); }
     virtual void SerializePrimitive(float& rValue, uint32 Flags)            { rValue = mpStream->ReadFloat(); }
     virtual void SerializePrimitive(double& rValue, uint32 Flags)           { rValue = mpStream->ReadDouble(); }
-    virtual void SerializePrimitive(TString& rValue, uint32 Flags)          { rValue = mpStream->ReadSizedString(); }
+    virtual void SerializePrimitive(TString& rValue, uint32 Flags)
+    {
+        if (mFormatFlags & BAF_VarInts)
+            rValue = mpStream->ReadString( (uint32) mpStream->ReadVarInt() );
+        else
+            rValue = mpStream->ReadSizedString();
+    }
     virtual void SerializePrimitive(CFourCC& rValue, uint32 Flags)          { rValue = CFourCC(*mpStream); }
     virtual void SerializePrimitive(CAssetID& rValue, uint32 Flags)         { rValue = CAssetID(*mpStream, Game()); }
     virtual void SerializeBulkData(void* pData, uint32 Size, uint32 Flags)  { mpStream->ReadBytes(pData, Size); }
+    virtual void SerializeBulkScalars(int16* pData, uint32 Count, uint32 Flags)     { mpStream->ReadArray(pData, Count); }
+    virtual void SerializeBulkScalars(int32* pData, uint32 Count, uint32 Flags)     { mpStream->ReadArray(pData, Count); }
+    virtual void SerializeBulkScalars(int64* pData, uint32 Count, uint32 Flags)     { mpStream->ReadArray(pData, Count); }
+    virtual void SerializeBulkScalars(float* pData, uint32 Count, uint32 Flags)     { mpStream->ReadArray(pData, Count); }
+    virtual void SerializeBulkScalars(double* pData, uint32 Count, uint32 Flags)    { mpStream->ReadArray(pData, Count); }
+
+private:
+    template<typename ValType>
+    inline ValType ReadInteger()
+    {
+        if (mFormatFlags & BAF_VarInts)
+        {
+            if constexpr (std::is_signed_v<ValType>)
+                return (ValType) mpStream->ReadSignedVarInt();
+            else
+                return (ValType) mpStream->ReadVarInt();
+        }
+        else
+        {
+            if constexpr (sizeof(ValType) == 2)
+                return (ValType) mpStream->ReadShort();
+            else if constexpr (sizeof(ValType) == 4)
+                return (ValType) mpStream->ReadLong();
+            else
+                return (ValType) mpStream->ReadLongLong();
+        }
+    }
 };
 
 #endif // CBINARYREADER
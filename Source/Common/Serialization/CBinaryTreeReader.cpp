@@ -0,0 +1,336 @@
+#include "CBinaryTreeReader.h"
+#include "Common/FileIO/CMappedFileInStream.h"
+
+CBinaryTreeReader::CBinaryTreeReader(const TString& rkFilename, uint32 Magic)
+    : IArchive()
+    , mMagicValid(false)
+    , mHeaderValid(false)
+    , mOwnsStream(true)
+    , mInValueNode(false)
+{
+    mArchiveFlags = AF_Reader | AF_Binary;
+    mpStream = new CMappedFileInStream(rkFilename, EEndian::BigEndian);
+    mStreamEndianness = EEndian::BigEndian;
+
+    if (mpStream->IsValid())
+    {
+        mMagicValid = (mpStream->ReadLong() == Magic);
+        mpStream->SetEndianness(EEndian::LittleEndian);
+    }
+
+    if (mpStream->IsValid() && mMagicValid)
+    {
+        mHeaderValid = ReadHeader();
+        SerializeVersion();
+    }
+}
+
+CBinaryTreeReader::CBinaryTreeReader(IInputStream *pStream, const CSerialVersion& rkVersion)
+    : IArchive()
+    , mpStream(pStream)
+    , mMagicValid(true)
+    , mHeaderValid(false)
+    , mOwnsStream(false)
+    , mInValueNode(false)
+{
+    ASSERT(pStream && pStream->IsValid());
+    mArchiveFlags = AF_Reader | AF_Binary;
+    mStreamEndianness = pStream->GetEndianness();
+    mpStream->SetEndianness(EEndian::LittleEndian);
+    SetVersion(rkVersion);
+    mHeaderValid = ReadHeader();
+}
+
+CBinaryTreeReader::~CBinaryTreeReader()
+{
+    if (mOwnsStream)
+        delete mpStream;
+    else
+        mpStream->SetEndianness(mStreamEndianness);
+}
+
+bool CBinaryTreeReader::ParamBegin(const char *pkName, uint32 Flags)
+{
+    return ParamBegin(pkName, CCRC32::StaticHashString(pkName), Flags);
+}
+
+bool CBinaryTreeReader::ParamBegin(const char *pkName, uint32 NameHash, uint32 Flags)
+{
+    SNode& rParent = mNodeStack.back();
+
+    if (rParent.Type != EBinaryTreeType::Compound)
+        return false;
+
+    // A name that isn't in the name table isn't anywhere in the file
+    int32 NameIndex = FindName(pkName, NameHash);
+
+    if (NameIndex == -1 && !(Flags & SH_IgnoreName))
+        return false;
+
+    // Check the next child first and check whether it's a match for the current parameter
+    if (rParent.NextChildOffset < rParent.PayloadOffset + rParent.PayloadSize)
+    {
+        mpStream->GoTo(rParent.NextChildOffset);
+        uint32 NextName = (uint32) mpStream->ReadVarInt();
+
+        if (NextName == (uint32) NameIndex || (Flags & SH_IgnoreName))
+        {
+            EnterNode();
+            return true;
+        }
+    }
+
+    // It's not a match - look the parameter up in the parent's child map, building it if needed
+    if (!rParent.HasChildMap)
+        BuildChildMap();
+
+    const std::unordered_map<uint32, uint64>& rkChildMap = mChildMaps[mNodeStack.size() - 1];
+    auto Iter = rkChildMap.find((uint32) NameIndex);
+
+    if (Iter != rkChildMap.end())
+    {
+        mpStream->GoTo(Iter->second);
+        mpStream->ReadVarInt();
+        EnterNode();
+        return true;
+    }
+
+    // None of the children were a match - this parameter isn't in the file
+    return false;
+}
+
+void CBinaryTreeReader::ParamEnd()
+{
+    ASSERT(mNodeStack.size() > 1);
+    const SNode& rkNode = mNodeStack.back();
+    uint64 EndOffset = rkNode.PayloadOffset + rkNode.PayloadSize;
+    mNodeStack.pop_back();
+
+    // Continue reading from the next sibling
+    mNodeStack.back().NextChildOffset = EndOffset;
+    mpStream->GoTo(EndOffset);
+}
+
+void CBinaryTreeReader::SerializePrimitive(TString& rValue, uint32 Flags)
+{
+    if (BeginValue() == EBinaryTreeType::String)
+    {
+        uint64 Length = mpStream->ReadVarInt();
+
+        if (Length <= mNodeStack.back().PayloadSize)
+            rValue = mpStream->ReadString((uint32) Length);
+    }
+
+    EndValue();
+}
+
+void CBinaryTreeReader::SerializePrimitive(CFourCC& rValue, uint32 Flags)
+{
+    if (BeginValue() == EBinaryTreeType::FourCC)
+        rValue = CFourCC( (uint32) mpStream->ReadLong() );
+
+    EndValue();
+}
+
+void CBinaryTreeReader::SerializePrimitive(CAssetID& rValue, uint32 Flags)
+{
+    if (BeginValue() == EBinaryTreeType::AssetID)
+    {
+        if (mNodeStack.back().PayloadSize == 4)
+            rValue = CAssetID( (uint32) mpStream->ReadLong(), k32Bit );
+        else
+            rValue = CAssetID( (uint64) mpStream->ReadLongLong(), k64Bit );
+    }
+
+    EndValue();
+}
+
+void CBinaryTreeReader::SerializeBulkData(void* pData, uint32 Size, uint32 Flags)
+{
+    if (BeginValue() == EBinaryTreeType::Bytes)
+    {
+        uint64 NumStored = mNodeStack.back().PayloadSize;
+        mpStream->ReadBytes(pData, (uint32) (NumStored < Size ? NumStored : Size));
+    }
+
+    EndValue();
+}
+
+// ************ PRIVATE ************
+bool CBinaryTreeReader::ReadHeader()
+{
+    // Counts and lengths come from the file, so they're checked against what's left of the stream
+    // before anything is allocated or read with them
+    uint64 StreamEnd = mpStream->Size64();
+    mNodeStack.reserve(20);
+    bool Valid = true;
+
+    // Name table
+    uint32 NumNames = 0;
+    uint64 NumNames64 = mpStream->ReadVarInt();
+
+    if (NumNames64 > StreamEnd - mpStream->Tell64())
+        Valid = false;
+    else
+    {
+        NumNames = (uint32) NumNames64;
+        mNames.reserve(NumNames);
+    }
+
+    for (uint32 NameIdx = 0; NameIdx < NumNames && Valid; NameIdx++)
+    {
+        uint64 Length = mpStream->ReadVarInt();
+
+        if (Length > StreamEnd - mpStream->Tell64())
+        {
+            Valid = false;
+            break;
+        }
+
+        mNames.push_back( mpStream->ReadString((uint32) Length) );
+        mNameLookup.emplace(CCRC32::StaticHashString(*mNames.back()), NameIdx);
+    }
+
+    // The table of contents becomes the root's child map; offsets are relative to the body
+    std::vector< std::pair<uint32, uint64> > TOC;
+
+    if (Valid)
+    {
+        uint64 NumEntries = mpStream->ReadVarInt();
+
+        if (NumEntries > (StreamEnd - mpStream->Tell64()) / 2)
+            Valid = false;
+        else
+        {
+            TOC.resize((uint32) NumEntries);
+
+            for (auto& rEntry : TOC)
+            {
+                rEntry.first = (uint32) mpStream->ReadVarInt();
+                rEntry.second = mpStream->ReadVarInt();
+            }
+        }
+    }
+
+    uint64 BodySize = (Valid ? mpStream->ReadVarInt() : 0);
+    uint64 BodyOffset = mpStream->Tell64();
+
+    if (Valid && BodySize > StreamEnd - BodyOffset)
+        Valid = false;
+
+    if (!Valid)
+    {
+        // Leave an empty root so params just read as missing
+        errorf("%s: Binary tree archive header is corrupt", *mpStream->GetSourceString());
+        mNames.clear();
+        mNameLookup.clear();
+        TOC.clear();
+        BodySize = 0;
+    }
+
+    mChildMaps.resize(1);
+    mChildMaps[0].reserve(TOC.size());
+
+    for (const auto& rkEntry : TOC)
+        mChildMaps[0].emplace(rkEntry.first, BodyOffset + rkEntry.second);
+
+    mNodeStack.push_back( SNode { BodyOffset, BodySize, BodyOffset, EBinaryTreeType::Compound, true } );
+    return Valid;
+}
+
+int32 CBinaryTreeReader::FindName(const char *pkName, uint32 NameHash) const
+{
+    auto Find = mNameLookup.find(NameHash);
+
+    if (Find != mNameLookup.end())
+    {
+        if (mNames[Find->second] == pkName)
+            return (int32) Find->second;
+
+        // Hash collision; fall back to a linear search
+        for (uint32 NameIdx = 0; NameIdx < mNames.size(); NameIdx++)
+        {
+            if (mNames[NameIdx] == pkName)
+                return (int32) NameIdx;
+        }
+    }
+
+    return -1;
+}
+
+void CBinaryTreeReader::EnterNode()
+{
+    // The stream is just past the child's name index
+    EBinaryTreeType Type = (EBinaryTreeType) mpStream->ReadByte();
+    uint64 Size = mpStream->ReadVarInt();
+    uint64 Offset = mpStream->Tell64();
+    mNodeStack.push_back( SNode { Offset, Size, Offset, Type, false } );
+}
+
+void CBinaryTreeReader::BuildChildMap()
+{
+    // Scan the parent's children once and record where each one is, so later lookups are O(1)
+    // instead of rescanning every sibling. The first child with a given name wins, like a linear scan.
+    uint32 Depth = mNodeStack.size() - 1;
+    SNode& rParent = mNodeStack[Depth];
+
+    if (mChildMaps.size() <= Depth)
+        mChildMaps.resize(Depth + 1);
+
+    std::unordered_map<uint32, uint64>& rChildMap = mChildMaps[Depth];
+    rChildMap.clear();
+
+    uint64 Offset = rParent.PayloadOffset;
+    uint64 EndOffset = rParent.PayloadOffset + rParent.PayloadSize;
+
+    while (Offset < EndOffset)
+    {
+        mpStream->GoTo(Offset);
+        uint32 NameIndex = (uint32) mpStream->ReadVarInt();
+        mpStream->ReadByte();
+        uint64 Size = mpStream->ReadVarInt();
+
+        rChildMap.emplace(NameIndex, Offset);
+        Offset = mpStream->Tell64() + Size;
+    }
+
+    rParent.HasChildMap = true;
+}
+
+EBinaryTreeType CBinaryTreeReader::BeginValue()
+{
+    // Values of parameters that have children are stored in an unnamed child
+    if (mNodeStack.back().Type == EBinaryTreeType::Compound)
+    {
+        if (!ParamBegin("", CCRC32::StaticHashString(""), 0))
+            return EBinaryTreeType::Empty;
+
+        mInValueNode = true;
+    }
+
+    const SNode& rkNode = mNodeStack.back();
+    mpStream->GoTo(rkNode.PayloadOffset);
+    return rkNode.Type;
+}
+
+void CBinaryTreeReader::EndValue()
+{
+    if (mInValueNode)
+    {
+        mInValueNode = false;
+        ParamEnd();
+    }
+}
+
+EBinaryTreeType CBinaryTreeReader::ArrayElementType(EBinaryTreeType ArrayType, uint32& rOutElementSize)
+{
+    switch (ArrayType)
+    {
+    case EBinaryTreeType::Int16Array:   rOutElementSize = 2; return EBinaryTreeType::Int16;
+    case EBinaryTreeType::Int32Array:   rOutElementSize = 4; return EBinaryTreeType::Int32;
+    case EBinaryTreeType::Int64Array:   rOutElementSize = 8; return EBinaryTreeType::Int64;
+    case EBinaryTreeType::FloatArray:   rOutElementSize = 4; return EBinaryTreeType::Float;
+    case EBinaryTreeType::DoubleArray:  rOutElementSize = 8; return EBinaryTreeType::Double;
+    default:                            rOutElementSize = 0; return EBinaryTreeType::Empty;
+    }
+}
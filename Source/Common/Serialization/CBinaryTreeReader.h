@@ -0,0 +1,149 @@
+#ifndef CBINARYTREEREADER
+#define CBINARYTREEREADER
+
+#include "IArchive.h"
+#include "BinaryCommon.h"
+#include "CSerialVersion.h"
+#include "Common/CFourCC.h"
+#include <unordered_map>
+
+/**
+ * Reader for archives written by CBinaryTreeWriter; see there for the format. Parameter names
+ * are resolved to name table indices, so matching children is an integer compare. Stored types
+ * are checked against the requested ones, and numeric values are converted if they differ.
+ */
+class CBinaryTreeReader : public IArchive
+{
+    struct SNode
+    {
+        uint64 PayloadOffset;
+        uint64 PayloadSize;
+        uint64 NextChildOffset;
+        EBinaryTreeType Type;
+        bool HasChildMap;
+    };
+    std::vector<SNode> mNodeStack;
+
+    // Per-parent lookup from name index to child offset, built the first time a parent's next
+    // child doesn't match the requested param. The root's is filled from the table of contents.
+    std::vector< std::unordered_map<uint32, uint64> > mChildMaps;
+
+    std::vector<TString> mNames;
+    std::unordered_map<uint32, uint32> mNameLookup; // Name hash -> index in mNames
+
+    IInputStream *mpStream;
+    EEndian mStreamEndianness; // Restored on the caller's stream when we're done with it
+    bool mMagicValid;
+    bool mHeaderValid;
+    bool mOwnsStream;
+    bool mInValueNode;
+
+public:
+    CBinaryTreeReader(const TString& rkFilename, uint32 Magic);
+    CBinaryTreeReader(IInputStream *pStream, const CSerialVersion& rkVersion);
+    ~CBinaryTreeReader();
+
+    inline bool IsValid() const { return mpStream->IsValid() && mMagicValid && mHeaderValid; }
+
+    // Interface
+    virtual bool ParamBegin(const char *pkName, uint32 Flags);
+    virtual bool ParamBegin(const char *pkName, uint32 NameHash, uint32 Flags);
+    virtual void ParamEnd();
+
+    virtual bool PreSerializePointer(void*& Pointer, uint32 Flags)
+    {
+        bool ValidPtr = (Pointer != nullptr);
+        *this << SerialParameter(SERIAL_NAME("PointerValid"), ValidPtr);
+        return ValidPtr;
+    }
+
+    virtual void SerializePrimitive(bool& rValue, uint32 Flags)             { ReadPrimitive(rValue); }
+    virtual void SerializePrimitive(char& rValue, uint32 Flags)             { ReadPrimitive(rValue); }
+    virtual void SerializePrimitive(int8& rValue, uint32 Flags)             { ReadPrimitive(rValue); }
+    virtual void SerializePrimitive(uint8& rValue, uint32 Flags)            { ReadPrimitive(rValue); }
+    virtual void SerializePrimitive(int16& rValue, uint32 Flags)            { ReadPrimitive(rValue); }
+    virtual void SerializePrimitive(uint16& rValue, uint32 Flags)           { ReadPrimitive(rValue); }
+    virtual void SerializePrimitive(int32& rValue, uint32 Flags)            { ReadPrimitive(rValue); }
+    virtual void SerializePrimitive(uint32& rValue, uint32 Flags)           { ReadPrimitive(rValue); }
+    virtual void SerializePrimitive(int64& rValue, uint32 Flags)            { ReadPrimitive(rValue); }
+    virtual void SerializePrimitive(uint64& rValue, uint32 Flags)           { ReadPrimitive(rValue); }
+    virtual void SerializePrimitive(float& rValue, uint32 Flags)            { ReadPrimitive(rValue); }
+    virtual void SerializePrimitive(double& rValue, uint32 Flags)           { ReadPrimitive(rValue); }
+    virtual void SerializePrimitive(TString& rValue, uint32 Flags);
+    virtual void SerializePrimitive(CFourCC& rValue, uint32 Flags);
+    virtual void SerializePrimitive(CAssetID& rValue, uint32 Flags);
+    virtual void SerializeBulkData(void* pData, uint32 Size, uint32 Flags);
+    virtual void SerializeBulkScalars(int16* pData, uint32 Count, uint32 Flags)     { ReadArray(EBinaryTreeType::Int16Array,  pData, Count); }
+    virtual void SerializeBulkScalars(int32* pData, uint32 Count, uint32 Flags)     { ReadArray(EBinaryTreeType::Int32Array,  pData, Count); }
+    virtual void SerializeBulkScalars(int64* pData, uint32 Count, uint32 Flags)     { ReadArray(EBinaryTreeType::Int64Array,  pData, Count); }
+    virtual void SerializeBulkScalars(float* pData, uint32 Count, uint32 Flags)     { ReadArray(EBinaryTreeType::FloatArray,  pData, Count); }
+    virtual void SerializeBulkScalars(double* pData, uint32 Count, uint32 Flags)    { ReadArray(EBinaryTreeType::DoubleArray, pData, Count); }
+
+private:
+    bool ReadHeader();
+    int32 FindName(const char *pkName, uint32 NameHash) const;
+    void EnterNode();
+    void BuildChildMap();
+    EBinaryTreeType BeginValue();
+    void EndValue();
+    static EBinaryTreeType ArrayElementType(EBinaryTreeType ArrayType, uint32& rOutElementSize);
+
+    template<typename ValType>
+    ValType ReadNumber(EBinaryTreeType Type, ValType Default)
+    {
+        switch (Type)
+        {
+        case EBinaryTreeType::Bool:     return (ValType) (mpStream->ReadByte() != 0);
+        case EBinaryTreeType::Int8:     return (ValType) mpStream->ReadByte();
+        case EBinaryTreeType::UInt8:    return (ValType) (uint8) mpStream->ReadByte();
+        case EBinaryTreeType::Int16:    return (ValType) mpStream->ReadShort();
+        case EBinaryTreeType::UInt16:   return (ValType) (uint16) mpStream->ReadShort();
+        case EBinaryTreeType::Int32:    return (ValType) mpStream->ReadLong();
+        case EBinaryTreeType::UInt32:   return (ValType) (uint32) mpStream->ReadLong();
+        case EBinaryTreeType::Int64:    return (ValType) mpStream->ReadLongLong();
+        case EBinaryTreeType::UInt64:   return (ValType) (uint64) mpStream->ReadLongLong();
+        case EBinaryTreeType::Float:    return (ValType) mpStream->ReadFloat();
+        case EBinaryTreeType::Double:   return (ValType) mpStream->ReadDouble();
+        default:                        return Default;
+        }
+    }
+
+    template<typename ValType>
+    void ReadPrimitive(ValType& rValue)
+    {
+        EBinaryTreeType Type = BeginValue();
+        rValue = ReadNumber(Type, rValue);
+        EndValue();
+    }
+
+    template<typename ValType>
+    void ReadArray(EBinaryTreeType ArrayType, ValType *pData, uint32 Count)
+    {
+        EBinaryTreeType Type = BeginValue();
+        uint64 PayloadSize = mNodeStack.back().PayloadSize;
+
+        if (Type == ArrayType)
+        {
+            uint64 NumStored = PayloadSize / sizeof(ValType);
+            mpStream->ReadArray(pData, (uint32) (NumStored < Count ? NumStored : Count));
+        }
+        else
+        {
+            // Stored as a different type, convert element by element
+            uint32 ElementSize;
+            EBinaryTreeType ElementType = ArrayElementType(Type, ElementSize);
+
+            if (ElementType != EBinaryTreeType::Empty)
+            {
+                uint64 NumStored = PayloadSize / ElementSize;
+
+                for (uint32 ElemIdx = 0; ElemIdx < NumStored && ElemIdx < Count; ElemIdx++)
+                    pData[ElemIdx] = ReadNumber(ElementType, pData[ElemIdx]);
+            }
+        }
+
+        EndValue();
+    }
+};
+
+#endif // CBINARYTREEREADER
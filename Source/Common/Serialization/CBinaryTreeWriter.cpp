@@ -0,0 +1,217 @@
+#include "CBinaryTreeWriter.h"
+#include "Common/FileIO/CFileOutStream.h"
+
+CBinaryTreeWriter::CBinaryTreeWriter(const TString& rkFilename, uint32 Magic, uint16 FileVersion /*= 0*/, EGame Game /*= EGame::Invalid*/)
+    : IArchive()
+    , mBodyStream(&mBody, EEndian::LittleEndian)
+    , mMagic(Magic)
+    , mOwnsStream(true)
+{
+    mpStream = new CFileOutStream(rkFilename, EEndian::BigEndian);
+    SetVersion(skCurrentArchiveVersion, FileVersion, Game);
+    Init();
+    SerializeVersion();
+}
+
+CBinaryTreeWriter::CBinaryTreeWriter(IOutputStream *pStream, uint16 FileVersion /*= 0*/, EGame Game /*= EGame::Invalid*/)
+    : IArchive()
+    , mBodyStream(&mBody, EEndian::LittleEndian)
+    , mpStream(pStream)
+    , mMagic(0)
+    , mOwnsStream(false)
+{
+    ASSERT(pStream && pStream->IsValid());
+    SetVersion(skCurrentArchiveVersion, FileVersion, Game);
+    Init();
+}
+
+CBinaryTreeWriter::CBinaryTreeWriter(IOutputStream *pStream, const CSerialVersion& rkVersion)
+    : IArchive()
+    , mBodyStream(&mBody, EEndian::LittleEndian)
+    , mpStream(pStream)
+    , mMagic(0)
+    , mOwnsStream(false)
+{
+    ASSERT(pStream && pStream->IsValid());
+    SetVersion(rkVersion);
+    Init();
+}
+
+CBinaryTreeWriter::~CBinaryTreeWriter()
+{
+    // Ensure all params have been finished
+    ASSERT(mNodeStack.size() == 1);
+
+    if (mOwnsStream)
+        mpStream->WriteLong(mMagic);
+
+    // Name table
+    mpStream->WriteVarInt(mNames.size());
+
+    for (const TString& rkName : mNames)
+    {
+        mpStream->WriteVarInt(rkName.Size());
+        mpStream->WriteBytes(rkName.Data(), rkName.Size());
+    }
+
+    // Table of contents
+    mpStream->WriteVarInt(mTOC.size());
+
+    for (const STOCEntry& rkEntry : mTOC)
+    {
+        mpStream->WriteVarInt(rkEntry.NameIndex);
+        mpStream->WriteVarInt(rkEntry.Offset);
+    }
+
+    // Body; WriteBytes takes 32-bit sizes, so very large archives go out in chunks
+    mpStream->WriteVarInt(mBody.size());
+
+    for (uint64 Offset = 0; Offset < mBody.size(); Offset += 0x40000000)
+    {
+        uint64 ChunkSize = mBody.size() - Offset;
+        if (ChunkSize > 0x40000000) ChunkSize = 0x40000000;
+        mpStream->WriteBytes(&mBody[Offset], (uint32) ChunkSize);
+    }
+
+    if (mOwnsStream)
+        delete mpStream;
+}
+
+bool CBinaryTreeWriter::ParamBegin(const char *pkName, uint32 Flags)
+{
+    return ParamBegin(pkName, CCRC32::StaticHashString(pkName), Flags);
+}
+
+bool CBinaryTreeWriter::ParamBegin(const char *pkName, uint32 NameHash, uint32 Flags)
+{
+    BeginNode( InternName(pkName, NameHash) );
+    return true;
+}
+
+void CBinaryTreeWriter::ParamEnd()
+{
+    ASSERT(mNodeStack.size() > 1);
+    const SNode& rkNode = mNodeStack.back();
+
+    // Only one byte was reserved for the size. If the payload is 128 bytes or more,
+    // it needs to be moved up to make room for the rest of the varint.
+    uint64 PayloadSize = mBody.size() - rkNode.PayloadOffset;
+    uint8 SizeBytes[gkMaxVarIntSize];
+    uint32 SizeLength = EncodeVarInt(PayloadSize, SizeBytes);
+
+    if (SizeLength > 1)
+    {
+        mBody.insert(mBody.begin() + rkNode.PayloadOffset, SizeLength - 1, 0);
+        mBodyStream.GoTo(mBody.size());
+    }
+
+    memcpy(&mBody[rkNode.TagOffset + 1], SizeBytes, SizeLength);
+    mNodeStack.pop_back();
+}
+
+void CBinaryTreeWriter::SerializePrimitive(TString& rValue, uint32 Flags)
+{
+    BeginValue(EBinaryTreeType::String);
+    mBodyStream.WriteVarInt(rValue.Size());
+    mBodyStream.WriteBytes(rValue.Data(), rValue.Size());
+    EndValue();
+}
+
+void CBinaryTreeWriter::SerializePrimitive(CAssetID& rValue, uint32 Flags)
+{
+    // The payload size tells the reader which ID length was written
+    EIDLength Length = CAssetID::GameIDLength(Game());
+    if (Length == kInvalidIDLength) Length = rValue.Length();
+
+    if (Length == k32Bit)
+        WriteValue(EBinaryTreeType::AssetID, rValue.ToLong());
+    else
+        WriteValue(EBinaryTreeType::AssetID, rValue.ToLongLong());
+}
+
+void CBinaryTreeWriter::SerializeBulkData(void* pData, uint32 Size, uint32 Flags)
+{
+    BeginValue(EBinaryTreeType::Bytes);
+    mBodyStream.WriteBytes(pData, Size);
+    EndValue();
+}
+
+// ************ PRIVATE ************
+void CBinaryTreeWriter::Init()
+{
+    mArchiveFlags = AF_Writer | AF_Binary;
+
+    // Name index 0 is reserved for the unnamed children that hold values of compound parameters
+    InternName("", CCRC32::StaticHashString(""));
+
+    // The root has no header of its own; the body is just its children
+    mNodeStack.reserve(20);
+    mNodeStack.push_back( SNode { 0, 0, EBinaryTreeType::Compound, false } );
+}
+
+uint32 CBinaryTreeWriter::InternName(const char *pkName, uint32 NameHash)
+{
+    auto Find = mNameLookup.find(NameHash);
+
+    if (Find != mNameLookup.end())
+    {
+        if (mNames[Find->second] == pkName)
+            return Find->second;
+
+        // Hash collision; fall back to a linear search
+        for (uint32 NameIdx = 0; NameIdx < mNames.size(); NameIdx++)
+        {
+            if (mNames[NameIdx] == pkName)
+                return NameIdx;
+        }
+    }
+
+    uint32 Index = mNames.size();
+    mNames.push_back(pkName);
+    mNameLookup.emplace(NameHash, Index);
+    return Index;
+}
+
+void CBinaryTreeWriter::BeginNode(uint32 NameIndex)
+{
+    SNode& rParent = mNodeStack.back();
+
+    if (rParent.Type == EBinaryTreeType::Empty)
+    {
+        rParent.Type = EBinaryTreeType::Compound;
+        mBody[rParent.TagOffset] = (char) EBinaryTreeType::Compound;
+    }
+
+    // Values have to come after a parameter's children, not before
+    ASSERT(rParent.Type == EBinaryTreeType::Compound);
+
+    if (mNodeStack.size() == 1)
+        mTOC.push_back( STOCEntry { NameIndex, mBody.size() } );
+
+    mBodyStream.WriteVarInt(NameIndex);
+    uint64 TagOffset = mBody.size();
+    mBodyStream.WriteByte( (int8) EBinaryTreeType::Empty );
+    mBodyStream.WriteByte(0); // Size filler
+    mNodeStack.push_back( SNode { TagOffset, mBody.size(), EBinaryTreeType::Empty, false } );
+}
+
+void CBinaryTreeWriter::BeginValue(EBinaryTreeType Type)
+{
+    // If the parameter already has children, its value goes in an unnamed child
+    if (mNodeStack.back().Type == EBinaryTreeType::Compound)
+    {
+        BeginNode(0);
+        mNodeStack.back().IsValueNode = true;
+    }
+
+    SNode& rNode = mNodeStack.back();
+    ASSERT(rNode.Type == EBinaryTreeType::Empty);
+    rNode.Type = Type;
+    mBody[rNode.TagOffset] = (char) Type;
+}
+
+void CBinaryTreeWriter::EndValue()
+{
+    if (mNodeStack.back().IsValueNode)
+        ParamEnd();
+}
@@ -0,0 +1,128 @@
+#ifndef CBINARYTREEWRITER
+#define CBINARYTREEWRITER
+
+#include "IArchive.h"
+#include "BinaryCommon.h"
+#include "CSerialVersion.h"
+#include "Common/CFourCC.h"
+#include "Common/FileIO/CVectorOutStream.h"
+#include <unordered_map>
+
+/**
+ * Self-describing binary archive. Each parameter is stored as
+ *   [varint name index][type tag][varint payload size][payload]
+ * Name indices refer to a table of names stored once per file. Like XML, parameters can be read
+ * back in any order and with changed types, but without any text parsing. Compound parameters
+ * hold their children back-to-back. A table of contents of the top-level parameters lets readers
+ * jump straight to any of them. Values are little-endian.
+ *
+ * File layout: [magic (file archives only)][name table][table of contents][varint body size][body]
+ * The body is built in memory, and everything is written out when the writer is destroyed.
+ */
+class CBinaryTreeWriter : public IArchive
+{
+    struct SNode
+    {
+        uint64 TagOffset;       // Offset of the type tag in mBody; the size follows it
+        uint64 PayloadOffset;
+        EBinaryTreeType Type;
+        bool IsValueNode;       // Unnamed child holding the value of a compound parameter
+    };
+    std::vector<SNode> mNodeStack;
+
+    struct STOCEntry
+    {
+        uint32 NameIndex;
+        uint64 Offset;
+    };
+    std::vector<STOCEntry> mTOC;
+
+    std::vector<TString> mNames;
+    std::unordered_map<uint32, uint32> mNameLookup; // Name hash -> index in mNames
+
+    std::vector<char> mBody;
+    CVectorOutStream mBodyStream; // Writes to mBody
+    IOutputStream *mpStream;
+    uint32 mMagic;
+    bool mOwnsStream;
+
+public:
+    CBinaryTreeWriter(const TString& rkFilename, uint32 Magic, uint16 FileVersion = 0, EGame Game = EGame::Invalid);
+    CBinaryTreeWriter(IOutputStream *pStream, uint16 FileVersion = 0, EGame Game = EGame::Invalid);
+    CBinaryTreeWriter(IOutputStream *pStream, const CSerialVersion& rkVersion);
+    ~CBinaryTreeWriter();
+
+    inline bool IsValid() const { return mpStream->IsValid(); }
+
+    // Interface
+    virtual bool ParamBegin(const char *pkName, uint32 Flags);
+    virtual bool ParamBegin(const char *pkName, uint32 NameHash, uint32 Flags);
+    virtual void ParamEnd();
+
+    virtual bool PreSerializePointer(void*& Pointer, uint32 Flags)
+    {
+        bool ValidPtr = (Pointer != nullptr);
+        *this << SerialParameter(SERIAL_NAME("PointerValid"), ValidPtr);
+        return ValidPtr;
+    }
+
+    virtual void SerializePrimitive(bool& rValue, uint32 Flags)             { WriteValue(EBinaryTreeType::Bool,   (uint8) (rValue ? 1 : 0)); }
+    virtual void SerializePrimitive(char& rValue, uint32 Flags)             { WriteValue(EBinaryTreeType::Int8,   rValue); }
+    virtual void SerializePrimitive(int8& rValue, uint32 Flags)             { WriteValue(EBinaryTreeType::Int8,   rValue); }
+    virtual void SerializePrimitive(uint8& rValue, uint32 Flags)            { WriteValue(EBinaryTreeType::UInt8,  rValue); }
+    virtual void SerializePrimitive(int16& rValue, uint32 Flags)            { WriteValue(EBinaryTreeType::Int16,  rValue); }
+    virtual void SerializePrimitive(uint16& rValue, uint32 Flags)           { WriteValue(EBinaryTreeType::UInt16, rValue); }
+    virtual void SerializePrimitive(int32& rValue, uint32 Flags)            { WriteValue(EBinaryTreeType::Int32,  rValue); }
+    virtual void SerializePrimitive(uint32& rValue, uint32 Flags)           { WriteValue(EBinaryTreeType::UInt32, rValue); }
+    virtual void SerializePrimitive(int64& rValue, uint32 Flags)            { WriteValue(EBinaryTreeType::Int64,  rValue); }
+    virtual void SerializePrimitive(uint64& rValue, uint32 Flags)           { WriteValue(EBinaryTreeType::UInt64, rValue); }
+    virtual void SerializePrimitive(float& rValue, uint32 Flags)            { WriteValue(EBinaryTreeType::Float,  rValue); }
+    virtual void SerializePrimitive(double& rValue, uint32 Flags)           { WriteValue(EBinaryTreeType::Double, rValue); }
+    virtual void SerializePrimitive(TString& rValue, uint32 Flags);
+    virtual void SerializePrimitive(CFourCC& rValue, uint32 Flags)          { WriteValue(EBinaryTreeType::FourCC, rValue.ToLong()); }
+    virtual void SerializePrimitive(CAssetID& rValue, uint32 Flags);
+    virtual void SerializeBulkData(void* pData, uint32 Size, uint32 Flags);
+    virtual void SerializeBulkScalars(int16* pData, uint32 Count, uint32 Flags)     { WriteArray(EBinaryTreeType::Int16Array,  pData, Count); }
+    virtual void SerializeBulkScalars(int32* pData, uint32 Count, uint32 Flags)     { WriteArray(EBinaryTreeType::Int32Array,  pData, Count); }
+    virtual void SerializeBulkScalars(int64* pData, uint32 Count, uint32 Flags)     { WriteArray(EBinaryTreeType::Int64Array,  pData, Count); }
+    virtual void SerializeBulkScalars(float* pData, uint32 Count, uint32 Flags)     { WriteArray(EBinaryTreeType::FloatArray,  pData, Count); }
+    virtual void SerializeBulkScalars(double* pData, uint32 Count, uint32 Flags)    { WriteArray(EBinaryTreeType::DoubleArray, pData, Count); }
+
+private:
+    void Init();
+    uint32 InternName(const char *pkName, uint32 NameHash);
+    void BeginNode(uint32 NameIndex);
+    void BeginValue(EBinaryTreeType Type);
+    void EndValue();
+
+    template<typename ValType>
+    inline void WriteValue(EBinaryTreeType Type, ValType Value)
+    {
+        BeginValue(Type);
+
+        if constexpr (std::is_same_v<ValType, float>)
+            mBodyStream.WriteFloat(Value);
+        else if constexpr (std::is_same_v<ValType, double>)
+            mBodyStream.WriteDouble(Value);
+        else if constexpr (sizeof(ValType) == 1)
+            mBodyStream.WriteByte((int8) Value);
+        else if constexpr (sizeof(ValType) == 2)
+            mBodyStream.WriteShort((int16) Value);
+        else if constexpr (sizeof(ValType) == 4)
+            mBodyStream.WriteLong((int32) Value);
+        else
+            mBodyStream.WriteLongLong((int64) Value);
+
+        EndValue();
+    }
+
+    template<typename ValType>
+    inline void WriteArray(EBinaryTreeType Type, const ValType *pkData, uint32 Count)
+    {
+        BeginValue(Type);
+        mBodyStream.WriteArray(pkData, Count);
+        EndValue();
+    }
+};
+
+#endif // CBINARYTREEWRITER
@@ -2,33 +2,52 @@
 #define CBINARYWRITER
 
 #include "IArchive.h"
+#include "BinaryCommon.h"
 #include "Common/CFourCC.h"
+#include "Common/FileIO/CSegmentedOutStream.h"
+#include "Common/FileIO/CVectorOutStream.h"
 
 class CBinaryWriter : public IArchive
 {
     struct SParameter
     {
-        uint32 Offset;
+        uint64 Offset;
         uint32 NumSubParams;
     };
     std::vector<SParameter> mParamStack;
 
-    IOutputStream *mpStream;
+    IOutputStream *mpOutput;
+    CSegmentedOutStream *mpArena; // Only used in streaming mode
+    IOutputStream *mpStream;      // Where the archive is written to; the arena in streaming mode, otherwise the output
+
+    // BAF_VarInts archives are built in one contiguous buffer, since finished varints can take more room
+    // than their filler and the data after them needs to be moved up. In streaming mode the buffer only
+    // holds the current top-level param.
+    std::vector<char> mVarIntData;
+    CVectorOutStream *mpVarIntStream;
     uint32 mMagic;
+    uint32 mFormatFlags;
     bool mOwnsStream;
+    bool mSizeOverflow; // A param was too large for 32-bit sizes; the archive is corrupt
 
 public:
-    CBinaryWriter(const TString& rkFilename, uint32 Magic, uint16 FileVersion = 0, EGame Game = EGame::Invalid)
+    CBinaryWriter(const TString& rkFilename, uint32 Magic, uint16 FileVersion = 0, EGame Game = EGame::Invalid, uint32 FormatFlags = 0,
+                  EBinaryWriteMode WriteMode = EBinaryWriteMode::Patch)
         : IArchive()
         , mMagic(Magic)
+        , mFormatFlags(FormatFlags)
         , mOwnsStream(true)
+        , mSizeOverflow(false)
     {
         mArchiveFlags = AF_Writer | AF_Binary;
-        mpStream = new CFileOutStream(rkFilename, EEndian::BigEndian);
+        mpOutput = new CFileOutStream(rkFilename, EEndian::BigEndian);
+        InitWriteMode(WriteMode);
 
-        if (mpStream->IsValid())
+        if (mpOutput->IsValid())
         {
-            mpStream->WriteLong(0); // Magic is written after the rest of the file has been successfully written
+            // Magic is written after the rest of the file has been successfully written.
+            // Streaming archives are sent out as they go, so they can't go back for it.
+            mpStream->WriteLong(SendsTopLevelParams() ? mMagic : 0);
             SetVersion(skCurrentArchiveVersion, FileVersion, Game);
         }
 
@@ -36,26 +55,34 @@ public:
         SerializeVersion();
     }
 
-    CBinaryWriter(IOutputStream *pStream, uint16 FileVersion = 0, EGame Game = EGame::Invalid)
+    CBinaryWriter(IOutputStream *pStream, uint16 FileVersion = 0, EGame Game = EGame::Invalid, uint32 FormatFlags = 0,
+                  EBinaryWriteMode WriteMode = EBinaryWriteMode::Patch)
         : IArchive()
         , mMagic(0)
+        , mFormatFlags(FormatFlags)
         , mOwnsStream(false)
+        , mSizeOverflow(false)
     {
         ASSERT(pStream && pStream->IsValid());
         mArchiveFlags = AF_Writer | AF_Binary;
-        mpStream = pStream;
+        mpOutput = pStream;
+        InitWriteMode(WriteMode);
         SetVersion(skCurrentArchiveVersion, FileVersion, Game);
         InitParamStack();
     }
 
-    CBinaryWriter(IOutputStream *pStream, const CSerialVersion& rkVersion)
+    CBinaryWriter(IOutputStream *pStream, const CSerialVersion& rkVersion, uint32 FormatFlags = 0,
+                  EBinaryWriteMode WriteMode = EBinaryWriteMode::Patch)
         : IArchive()
         , mMagic(0)
+        , mFormatFlags(FormatFlags)
         , mOwnsStream(false)
+        , mSizeOverflow(false)
     {
         ASSERT(pStream && pStream->IsValid());
         mArchiveFlags = AF_Writer | AF_Binary;
-        mpStream = pStream;
+        mpOutput = pStream;
+        InitWriteMode(WriteMode);
         SetVersion(rkVersion);
         InitParamStack();
     }
@@ -68,98 +95,273 @@ public:
         // Finish root param
         ParamEnd();
 
-        // Write magic and delete stream
-        if (mOwnsStream)
+        // Write magic. It's left as 0 on corrupt archives so they fail to load.
+        if (mOwnsStream && !mSizeOverflow && !SendsTopLevelParams())
         {
             mpStream->GoTo(0);
             mpStream->WriteLong(mMagic);
-            delete mpStream;
         }
+
+        // Send out whatever is still buffered. In streaming mode the root's ParamEnd already did.
+        FlushBuffer();
+        delete mpArena;
+        delete mpVarIntStream;
+
+        if (mOwnsStream)
+            delete mpOutput;
     }
 
-    inline bool IsValid() const { return mpStream->IsValid(); }
+    inline bool IsValid() const { return mpOutput->IsValid() && !mSizeOverflow; }
 
 private:
+    void InitWriteMode(EBinaryWriteMode WriteMode)
+    {
+        mpArena = nullptr;
+        mpVarIntStream = nullptr;
+
+        // Top-level params are sent out as they finish, so the root's child count has to go in a trailer
+        if (WriteMode == EBinaryWriteMode::Streaming)
+            mFormatFlags |= BAF_RootTrailer;
+
+        if (mFormatFlags & BAF_VarInts)
+        {
+            mpVarIntStream = new CVectorOutStream(&mVarIntData, mpOutput->GetEndianness());
+            mpStream = mpVarIntStream;
+        }
+        else if (WriteMode == EBinaryWriteMode::Streaming)
+        {
+            mpArena = new CSegmentedOutStream(mpOutput->GetEndianness());
+            mpStream = mpArena;
+        }
+        else
+            mpStream = mpOutput;
+    }
+
+    inline bool IsRootWithTrailer() const
+    {
+        return mParamStack.size() == 1 && (mFormatFlags & BAF_RootTrailer);
+    }
+
+    inline bool SendsTopLevelParams() const
+    {
+        // Buffered archives with a root trailer send each top-level param out once it ends, so nothing before it can be patched
+        return (mFormatFlags & BAF_RootTrailer) && mpStream != mpOutput;
+    }
+
+    void FlushBuffer()
+    {
+        // Sends out everything that's been written so far and frees the memory it used
+        if (mpArena)
+        {
+            mpArena->WriteTo(*mpOutput);
+            mpArena->Clear();
+        }
+        else if (mpVarIntStream)
+        {
+            // WriteBytes takes 32-bit sizes, so very large buffers go out in chunks
+            for (uint64 Offset = 0; Offset < mVarIntData.size(); Offset += 0x40000000)
+            {
+                uint64 ChunkSize = mVarIntData.size() - Offset;
+                if (ChunkSize > 0x40000000) ChunkSize = 0x40000000;
+                mpOutput->WriteBytes(&mVarIntData[Offset], (uint32) ChunkSize);
+            }
+
+            mpVarIntStream->Clear();
+        }
+    }
+
     void InitParamStack()
     {
         mParamStack.reserve(20);
-        mpStream->WriteLong(0xFFFFFFFF);
-        mpStream->WriteLong(0); // Size filler
-        mParamStack.push_back( SParameter { mpStream->Tell(), 0 } );
+        mpStream->WriteLong(~mFormatFlags); // Root ID holds the format flags
+        WriteSize(0); // Size filler
+        mParamStack.push_back( SParameter { mpStream->Tell64(), 0 } );
+    }
+
+    inline uint32 SizeFieldLength() const
+    {
+        return ((mFormatFlags & BAF_64BitSizes) ? 8 : 4);
+    }
+
+    void WriteSize(uint64 Size)
+    {
+        if (mFormatFlags & BAF_VarInts)
+            mpStream->WriteVarInt(Size);
+        else if (mFormatFlags & BAF_64BitSizes)
+            mpStream->WriteLongLong(Size);
+        else
+        {
+            // Archives larger than 4 GiB need to be written with BAF_64BitSizes or BAF_VarInts
+            if (Size > 0xFFFFFFFF && !mSizeOverflow)
+            {
+                errorf("%s: Parameter is larger than 4 GiB; the archive needs to be written with BAF_64BitSizes", *mpOutput->GetDestString());
+                mSizeOverflow = true;
+            }
+
+            mpStream->WriteLong((uint32) Size);
+        }
+    }
+
+    void EndVarIntParam()
+    {
+        // One byte was reserved for the size, and for the child count if the param has children.
+        // If the encoded values are longer than that, the param data is moved up to make room.
+        SParameter& rParam = mParamStack.back();
+        uint64 StartOffset = rParam.Offset;
+        uint32 CountFillerLength = (rParam.NumSubParams > 0 ? 1 : 0);
+
+        uint8 Bytes[gkMaxVarIntSize * 2];
+        uint32 CountLength = 0;
+
+        if (rParam.NumSubParams > 0 || mParamStack.size() == 1)
+            CountLength = EncodeVarInt(rParam.NumSubParams, Bytes + gkMaxVarIntSize);
+
+        uint64 ParamSize = mVarIntData.size() - StartOffset - CountFillerLength + CountLength;
+        uint32 SizeLength = EncodeVarInt(ParamSize, Bytes);
+        memmove(Bytes + SizeLength, Bytes + gkMaxVarIntSize, CountLength);
+
+        uint64 FillerOffset = StartOffset - 1;
+        uint32 FillerLength = 1 + CountFillerLength;
+        uint32 NewLength = SizeLength + CountLength;
+
+        if (NewLength > FillerLength)
+            mVarIntData.insert(mVarIntData.begin() + FillerOffset + FillerLength, NewLength - FillerLength, 0);
+
+        memcpy(&mVarIntData[FillerOffset], Bytes, NewLength);
+        mpStream->GoTo(mVarIntData.size());
+        mParamStack.pop_back();
     }
 
 public:
     // Interface
     virtual bool ParamBegin(const char *pkName, uint32 Flags)
+    {
+        return ParamBegin(pkName, CCRC32::StaticHashString(pkName), Flags);
+    }
+
+    virtual bool ParamBegin(const char *pkName, uint32 ParamID, uint32 Flags)
     {
         // Update parent param
         mParamStack.back().NumSubParams++;
 
-        if (mParamStack.back().NumSubParams == 1)
-            mpStream->WriteLong(-1); // Sub-param count filler
+        if (mParamStack.back().NumSubParams == 1 && !IsRootWithTrailer())
+        {
+            // Sub-param count filler
+            if (mFormatFlags & BAF_VarInts)
+                mpStream->WriteByte(0);
+            else
+                mpStream->WriteLong(-1);
+        }
 
         // Write param metadata
-        uint32 ParamID = TString(pkName).Hash32();
         mpStream->WriteLong(ParamID);
-        mpStream->WriteLong(-1); // Param size filler
+        WriteSize(0); // Param size filler
 
         // Add new param to the stack
-        mParamStack.push_back( SParameter { mpStream->Tell(), 0 } );
+        mParamStack.push_back( SParameter { mpStream->Tell64(), 0 } );
 
         return true;
     }
 
     virtual void ParamEnd()
     {
-        // Write param size
-        SParameter& rParam = mParamStack.back();
-        uint32 StartOffset = rParam.Offset;
-        uint32 EndOffset = mpStream->Tell();
-        uint32 ParamSize = (EndOffset - StartOffset);
+        if (IsRootWithTrailer())
+        {
+            // The trailer count is fixed-size even in varint archives, so readers can find it from the end of the stream
+            mpStream->WriteLong(mParamStack.back().NumSubParams);
+            mParamStack.pop_back();
+            FlushBuffer();
+            return;
+        }
 
-        mpStream->GoTo(StartOffset - 4);
-        mpStream->WriteLong(ParamSize);
+        if (mFormatFlags & BAF_VarInts)
+            EndVarIntParam();
 
-        // Write param child count
-        if (rParam.NumSubParams > 0 || mParamStack.size() == 1)
+        else
         {
-            mpStream->WriteLong(rParam.NumSubParams);
+            // Write param size
+            SParameter& rParam = mParamStack.back();
+            uint64 StartOffset = rParam.Offset;
+            uint64 EndOffset = mpStream->Tell64();
+            uint64 ParamSize = (EndOffset - StartOffset);
+
+            mpStream->GoTo(StartOffset - SizeFieldLength());
+            WriteSize(ParamSize);
+
+            // Write param child count
+            if (rParam.NumSubParams > 0 || mParamStack.size() == 1)
+            {
+                mpStream->WriteLong(rParam.NumSubParams);
+            }
+
+            mpStream->GoTo(EndOffset);
+            mParamStack.pop_back();
         }
 
-        mpStream->GoTo(EndOffset);
-        mParamStack.pop_back();
+        // Top-level params are complete once they end, so they can go out right away
+        if (mParamStack.size() == 1 && (mFormatFlags & BAF_RootTrailer))
+            FlushBuffer();
     }
 
     virtual bool PreSerializePointer(void*& Pointer, uint32 Flags)
     {
         bool ValidPtr = (Pointer != nullptr);
-        *this << SerialParameter("PointerValid", ValidPtr);
+        *this << SerialParameter(SERIAL_NAME("PointerValid"), ValidPtr);
         return ValidPtr;
     }
 
-    virtual void SerializeContainerSize(uint32& rSize, const TString& /*rkElemName*/)
-    {
-        // Normally handled by ParamBegin and ParamEnd but we need to do something here to account for zero-sized containers
-        if (rSize == 0)
-            mpStream->WriteLong(0);
-    }
-
     virtual void SerializePrimitive(bool& rValue, uint32 Flags)             { mpStream->WriteBool(rValue); }
     virtual void SerializePrimitive(char& rValue, uint32 Flags)             { mpStream->WriteByte(rValue); }
     virtual void SerializePrimitive(int8& rValue, uint32 Flags)             { mpStream->WriteByte(rValue); }
     virtual void SerializePrimitive(uint8& rValue, uint32 Flags)            { mpStream->WriteByte(rValue); }
-    virtual void SerializePrimitive(int16& rValue, uint32 Flags)            { mpStream->WriteShort(rValue); }
-    virtual void SerializePrimitive(uint16& rValue, uint32 Flags)           { mpStream->WriteShort(rValue); }
-    virtual void SerializePrimitive(int32& rValue, uint32 Flags)            { mpStream->WriteLong(rValue); }
-    virtual void SerializePrimitive(uint32& rValue, uint32 Flags)           { mpStream->WriteLong(rValue); }
-    virtual void SerializePrimitive(int64& rValue, uint32 Flags)            { mpStream->WriteLongLong(rValue); }
-    virtual void SerializePrimitive(uint64& rValue, uint32 Flags)           { mpStream->WriteLongLong(rValue); }
+    virtual void SerializePrimitive(int16& rValue, uint32 Flags)            { WriteInteger(rValue); }
+    virtual void SerializePrimitive(uint16& rValue, uint32 Flags)           { WriteInteger(rValue); }
+    virtual void SerializePrimitive(int32& rValue, uint32 Flags)            { WriteInteger(rValue); }
+    virtual void SerializePrimitive(uint32& rValue, uint32 Flags)           { WriteInteger(rValue); }
+    virtual void SerializePrimitive(int64& rValue, uint32 Flags)            { WriteInteger(rValue); }
+    virtual void SerializePrimitive(uint64& rValue, uint32 Flags)           { WriteInteger(rValue); }
     virtual void SerializePrimitive(float& rValue, uint32 Flags)            { mpStream->WriteFloat(rValue); }
     virtual void SerializePrimitive(double& rValue, uint32 Flags)           { mpStream->WriteDouble(rValue); }
-    virtual void SerializePrimitive(TString& rValue, uint32 Flags)          { mpStream->WriteSizedString(rValue); }
+    virtual void SerializePrimitive(TString& rValue, uint32 Flags)
+    {
+        if (mFormatFlags & BAF_VarInts)
+        {
+            mpStream->WriteVarInt(rValue.Size());
+            mpStream->WriteBytes(rValue.Data(), rValue.Size());
+        }
+        else
+            mpStream->WriteSizedString(rValue);
+    }
     virtual void SerializePrimitive(CFourCC& rValue, uint32 Flags)          { rValue.Write(*mpStream); }
     virtual void SerializePrimitive(CAssetID& rValue, uint32 Flags)         { rValue.Write(*mpStream, CAssetID::GameIDLength(Game())); }
     virtual void SerializeBulkData(void* pData, uint32 Size, uint32 Flags)  { mpStream->WriteBytes(pData, Size); }
+    virtual void SerializeBulkScalars(int16* pData, uint32 Count, uint32 Flags)     { mpStream->WriteArray(pData, Count); }
+    virtual void SerializeBulkScalars(int32* pData, uint32 Count, uint32 Flags)     { mpStream->WriteArray(pData, Count); }
+    virtual void SerializeBulkScalars(int64* pData, uint32 Count, uint32 Flags)     { mpStream->WriteArray(pData, Count); }
+    virtual void SerializeBulkScalars(float* pData, uint32 Count, uint32 Flags)     { mpStream->WriteArray(pData, Count); }
+    virtual void SerializeBulkScalars(double* pData, uint32 Count, uint32 Flags)    { mpStream->WriteArray(pData, Count); }
+
+private:
+    template<typename ValType>
+    inline void WriteInteger(ValType Value)
+    {
+        if (mFormatFlags & BAF_VarInts)
+        {
+            if constexpr (std::is_signed_v<ValType>)
+                mpStream->WriteSignedVarInt(Value);
+            else
+                mpStream->WriteVarInt(Value);
+        }
+        else
+        {
+            if constexpr (sizeof(ValType) == 2)
+                mpStream->WriteShort(Value);
+            else if constexpr (sizeof(ValType) == 4)
+                mpStream->WriteLong(Value);
+            else
+                mpStream->WriteLongLong(Value);
+        }
+    }
 };
 
 #endif // CBINARYWRITER
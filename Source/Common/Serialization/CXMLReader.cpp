@@ -0,0 +1,514 @@
+#include "CXMLReader.h"
+#include "Common/FileIO/CMappedFileInStream.h"
+#include <cstring>
+
+// Window size used for streams that can't be addressed directly
+static const uint32 skWindowSize = 0x10000;
+
+static inline bool IsXMLWhitespace(char Chr)
+{
+    return (Chr == ' ' || Chr == '\t' || Chr == '\n' || Chr == '\r');
+}
+
+static inline bool IsXMLNameChar(char Chr)
+{
+    return (Chr != '\0' && Chr != '/' && Chr != '>' && Chr != '=' && !IsXMLWhitespace(Chr));
+}
+
+CXMLReader::CXMLReader(const TString& rkFileName)
+    : IArchive()
+    , mDepth(0)
+    , mAttribute(-1)
+    , mOwnsStream(true)
+{
+    mpStream = new CMappedFileInStream(rkFileName);
+
+    if (!mpStream->IsValid())
+        errorf("%s: Failed to open XML for read", *rkFileName);
+    else
+        Init();
+}
+
+CXMLReader::CXMLReader(IInputStream *pStream)
+    : IArchive()
+    , mDepth(0)
+    , mAttribute(-1)
+    , mpStream(pStream)
+    , mOwnsStream(false)
+{
+    ASSERT(pStream && pStream->IsValid());
+    Init();
+}
+
+CXMLReader::~CXMLReader()
+{
+    if (mOwnsStream)
+        delete mpStream;
+}
+
+bool CXMLReader::ParamBegin(const char *pkName, uint32 Flags)
+{
+    return ParamBegin(pkName, CCRC32::StaticHashString(pkName), Flags);
+}
+
+bool CXMLReader::ParamBegin(const char *pkName, uint32 NameHash, uint32 Flags)
+{
+    ASSERT(IsValid());
+    ASSERT(mAttribute == -1); // Attributes cannot have sub-children
+    SXMLElement& rParent = mElemStack[mDepth - 1];
+
+    // Read from an attribute if requested
+    if (Flags & SH_Attribute)
+    {
+        uint32 NameLength = strlen(pkName);
+
+        for (uint32 AttribIdx = 0; AttribIdx < rParent.Attributes.size(); AttribIdx++)
+        {
+            const SXMLAttribute& rkAttrib = rParent.Attributes[AttribIdx];
+
+            if (rkAttrib.NameLength == NameLength && NameMatches(rkAttrib.NameOffset, pkName))
+            {
+                mAttribute = (int32) AttribIdx;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    if (rParent.IsEmpty)
+        return false;
+
+    // Usually parameters are read in the same order they were written, so check the next child first
+    uint64 ChildOffset = rParent.NextChildOffset;
+
+    if ( FindChildTag(ChildOffset) && ((Flags & SH_IgnoreName) || NameMatches(ChildOffset + 1, pkName)) )
+        return EnterElement(ChildOffset);
+
+    // It didn't match, so look the parameter up among the parent's other children.
+    // The first miss indexes all of them; this only holds one entry per distinct name.
+    if (!rParent.IsIndexed)
+    {
+        uint64 Offset = rParent.ContentOffset;
+
+        while (FindChildTag(Offset))
+        {
+            rParent.ChildIndex.emplace(HashName(Offset + 1), Offset);
+            Offset = SkipElement(Offset);
+        }
+
+        rParent.IsIndexed = true;
+    }
+
+    auto Find = rParent.ChildIndex.find(NameHash);
+
+    if (Find != rParent.ChildIndex.end() && NameMatches(Find->second + 1, pkName))
+        return EnterElement(Find->second);
+
+    // We couldn't find a matching element, so we can't load this parameter.
+    return false;
+}
+
+void CXMLReader::ParamEnd()
+{
+    if (mAttribute != -1)
+    {
+        mAttribute = -1;
+        return;
+    }
+
+    ASSERT(mDepth > 1);
+    SXMLElement& rElem = mElemStack[mDepth - 1];
+    uint64 EndOffset = (rElem.IsEmpty ? rElem.ContentOffset : SkipContent(rElem.NextChildOffset));
+
+    // Continue reading from the next sibling
+    mDepth--;
+    mElemStack[mDepth - 1].NextChildOffset = EndOffset;
+}
+
+TString CXMLReader::ReadParam()
+{
+    if (mAttribute != -1)
+    {
+        const SXMLAttribute& rkAttrib = mElemStack[mDepth - 1].Attributes[mAttribute];
+        return DecodeText(rkAttrib.ValueOffset, rkAttrib.ValueOffset + rkAttrib.ValueLength);
+    }
+
+    const SXMLElement& rkElem = mElemStack[mDepth - 1];
+    if (rkElem.IsEmpty) return "";
+
+    // Element text runs up to the first child or the end tag. CDATA sections are part of the text.
+    TString Out;
+    uint64 Offset = rkElem.ContentOffset;
+
+    while (Offset < mDataSize)
+    {
+        uint64 TextEnd = FindChar(Offset, '<');
+        Out += DecodeText(Offset, TextEnd);
+
+        if (MatchString(TextEnd, "<![CDATA["))
+        {
+            uint64 DataStart = TextEnd + 9;
+            Offset = FindString(DataStart, "]]>");
+
+            for (uint64 CharIdx = DataStart; CharIdx < Offset - 3; CharIdx++)
+                Out += CharAt(CharIdx);
+        }
+        else if (MatchString(TextEnd, "<!--"))
+            Offset = FindString(TextEnd + 4, "-->");
+        else
+            break;
+    }
+
+    return Out;
+}
+
+void CXMLReader::SerializeArraySize(uint32& Value)
+{
+    const SXMLElement& rkElem = mElemStack[mDepth - 1];
+    Value = 0;
+
+    if (!rkElem.IsEmpty)
+    {
+        uint64 Offset = rkElem.ContentOffset;
+
+        while (FindChildTag(Offset))
+        {
+            Offset = SkipElement(Offset);
+            Value++;
+        }
+    }
+}
+
+// ************ PRIVATE ************
+void CXMLReader::Init()
+{
+    mArchiveFlags = AF_Reader | AF_Text;
+    mDataSize = mpStream->Size64();
+
+    if (mpStream->IsMemoryBacked() && mpStream->Data())
+    {
+        mpWindow = (const char*) mpStream->Data();
+        mWindowOffset = 0;
+        mWindowSize = mDataSize;
+    }
+    else
+    {
+        mWindowBuffer.resize(skWindowSize);
+        mpWindow = mWindowBuffer.data();
+        mWindowOffset = 0;
+        mWindowSize = 0;
+    }
+
+    // Set current element to the root element; read version
+    uint64 RootOffset = 0;
+
+    if (!FindChildTag(RootOffset) || !EnterElement(RootOffset))
+    {
+        errorf("Failed to open XML for read: no root element");
+        return;
+    }
+
+    SerializeVersion();
+}
+
+bool CXMLReader::FillWindow(uint64 Offset)
+{
+    if (Offset >= mDataSize || mWindowBuffer.empty())
+        return false;
+
+    uint64 Remaining = mDataSize - Offset;
+    mWindowOffset = Offset;
+    mWindowSize = (Remaining < skWindowSize ? Remaining : skWindowSize);
+
+    mpStream->GoTo(Offset);
+    mpStream->ReadBytes(mWindowBuffer.data(), (uint32) mWindowSize);
+    return true;
+}
+
+uint64 CXMLReader::FindChar(uint64 Offset, char Chr)
+{
+    // Returns the offset of the next occurrence of Chr, or the end of the file
+    while (Offset < mDataSize)
+    {
+        if (Offset - mWindowOffset >= mWindowSize)
+            FillWindow(Offset);
+
+        const char *pkStart = mpWindow + (Offset - mWindowOffset);
+        uint64 Count = mWindowSize - (Offset - mWindowOffset);
+        const char *pkFound = (const char*) memchr(pkStart, Chr, (size_t) Count);
+
+        if (pkFound)
+            return Offset + (pkFound - pkStart);
+
+        Offset += Count;
+    }
+
+    return mDataSize;
+}
+
+uint64 CXMLReader::FindString(uint64 Offset, const char *pkString)
+{
+    // Returns the offset just past the next occurrence of pkString, or the end of the file
+    while (Offset < mDataSize)
+    {
+        Offset = FindChar(Offset, pkString[0]);
+
+        if (MatchString(Offset, pkString))
+            return Offset + strlen(pkString);
+
+        Offset++;
+    }
+
+    return mDataSize;
+}
+
+bool CXMLReader::MatchString(uint64 Offset, const char *pkString)
+{
+    for (; *pkString; pkString++, Offset++)
+    {
+        if (Offset >= mDataSize || CharAt(Offset) != *pkString)
+            return false;
+    }
+
+    return true;
+}
+
+bool CXMLReader::FindNextTag(uint64& rOffset)
+{
+    // Advances to the next start or end tag, skipping text, comments, CDATA and other markup
+    while (true)
+    {
+        rOffset = FindChar(rOffset, '<');
+        if (rOffset >= mDataSize) return false;
+
+        char Next = CharAt(rOffset + 1);
+
+        if (Next == '?')
+            rOffset = FindString(rOffset + 2, "?>");
+
+        else if (Next == '!')
+        {
+            if (MatchString(rOffset, "<!--"))
+                rOffset = FindString(rOffset + 4, "-->");
+            else if (MatchString(rOffset, "<![CDATA["))
+                rOffset = FindString(rOffset + 9, "]]>");
+            else
+                rOffset = FindChar(rOffset, '>') + 1;
+        }
+
+        else
+            return true;
+    }
+}
+
+bool CXMLReader::FindChildTag(uint64& rOffset)
+{
+    // Returns false when we reach the parent's end tag
+    return FindNextTag(rOffset) && CharAt(rOffset + 1) != '/';
+}
+
+uint64 CXMLReader::SkipStartTag(uint64 Offset, bool& rOutIsEmpty)
+{
+    // Offset points at the '<'. Returns the offset just past the closing '>'.
+    Offset++;
+
+    while (Offset < mDataSize)
+    {
+        char Chr = CharAt(Offset);
+
+        if (Chr == '"' || Chr == '\'')
+            Offset = FindChar(Offset + 1, Chr) + 1;
+
+        else if (Chr == '>')
+        {
+            rOutIsEmpty = (CharAt(Offset - 1) == '/');
+            return Offset + 1;
+        }
+
+        else
+            Offset++;
+    }
+
+    rOutIsEmpty = true;
+    return mDataSize;
+}
+
+uint64 CXMLReader::SkipContent(uint64 Offset)
+{
+    // Skips to just past the end tag of the element whose content contains Offset
+    uint32 Depth = 0;
+
+    while (FindNextTag(Offset))
+    {
+        if (CharAt(Offset + 1) == '/')
+        {
+            Offset = FindChar(Offset, '>') + 1;
+            if (Depth == 0) return Offset;
+            Depth--;
+        }
+        else
+        {
+            bool IsEmpty;
+            Offset = SkipStartTag(Offset, IsEmpty);
+            if (!IsEmpty) Depth++;
+        }
+    }
+
+    return mDataSize;
+}
+
+uint64 CXMLReader::SkipElement(uint64 Offset)
+{
+    bool IsEmpty;
+    Offset = SkipStartTag(Offset, IsEmpty);
+    return (IsEmpty ? Offset : SkipContent(Offset));
+}
+
+bool CXMLReader::EnterElement(uint64 Offset)
+{
+    if (mElemStack.size() <= mDepth)
+        mElemStack.resize(mDepth + 1);
+
+    SXMLElement& rElem = mElemStack[mDepth];
+    rElem.Attributes.clear();
+    rElem.ChildIndex.clear();
+    rElem.IsIndexed = false;
+
+    // Skip the element name, then parse attributes until the end of the tag
+    Offset++;
+    while (IsXMLNameChar(CharAt(Offset))) Offset++;
+
+    while (Offset < mDataSize)
+    {
+        char Chr = CharAt(Offset);
+
+        if (IsXMLWhitespace(Chr))
+            Offset++;
+
+        else if (Chr == '/' || Chr == '>')
+        {
+            rElem.IsEmpty = (Chr == '/');
+            rElem.ContentOffset = FindChar(Offset, '>') + 1;
+            rElem.NextChildOffset = rElem.ContentOffset;
+            mDepth++;
+            return true;
+        }
+
+        else
+        {
+            SXMLAttribute Attrib;
+            Attrib.NameOffset = Offset;
+            while (IsXMLNameChar(CharAt(Offset))) Offset++;
+            Attrib.NameLength = (uint32) (Offset - Attrib.NameOffset);
+
+            while (IsXMLWhitespace(CharAt(Offset))) Offset++;
+            if (CharAt(Offset) != '=') break;
+            Offset++;
+            while (IsXMLWhitespace(CharAt(Offset))) Offset++;
+
+            char Quote = CharAt(Offset);
+            if (Quote != '"' && Quote != '\'') break;
+
+            Attrib.ValueOffset = Offset + 1;
+            Offset = FindChar(Attrib.ValueOffset, Quote);
+            Attrib.ValueLength = (uint32) (Offset - Attrib.ValueOffset);
+            Offset++;
+
+            rElem.Attributes.push_back(Attrib);
+        }
+    }
+
+    errorf("Malformed XML start tag at offset 0x%X", (uint32) Offset);
+    return false;
+}
+
+bool CXMLReader::NameMatches(uint64 Offset, const char *pkName)
+{
+    return MatchString(Offset, pkName) && !IsXMLNameChar(CharAt(Offset + strlen(pkName)));
+}
+
+uint32 CXMLReader::HashName(uint64 Offset)
+{
+    // Must match CCRC32::StaticHashString so it can be compared against SerialParameter name hashes
+    CCRC32 Hasher;
+
+    for (char Chr = CharAt(Offset); IsXMLNameChar(Chr); Chr = CharAt(++Offset))
+        Hasher.Hash(Chr);
+
+    return Hasher.Digest();
+}
+
+TString CXMLReader::DecodeText(uint64 Offset, uint64 End)
+{
+    TString Out;
+    Out.Reserve((uint) (End - Offset));
+
+    while (Offset < End)
+    {
+        char Chr = CharAt(Offset++);
+
+        if (Chr != '&')
+        {
+            Out += Chr;
+            continue;
+        }
+
+        // Entity reference
+        uint64 EntityEnd = FindChar(Offset, ';');
+        if (EntityEnd >= End) { Out += Chr; continue; }
+
+        if      (MatchString(Offset, "lt;"))   Out += '<';
+        else if (MatchString(Offset, "gt;"))   Out += '>';
+        else if (MatchString(Offset, "amp;"))  Out += '&';
+        else if (MatchString(Offset, "quot;")) Out += '"';
+        else if (MatchString(Offset, "apos;")) Out += '\'';
+
+        else if (CharAt(Offset) == '#')
+        {
+            // Numeric character reference; encode as UTF-8
+            bool IsHex = (CharAt(Offset + 1) == 'x');
+            uint32 CodePoint = 0;
+
+            for (uint64 DigitIdx = Offset + (IsHex ? 2 : 1); DigitIdx < EntityEnd; DigitIdx++)
+            {
+                char Digit = CharAt(DigitIdx);
+                uint32 Value = (Digit >= '0' && Digit <= '9') ? (Digit - '0') :
+                               (Digit >= 'a' && Digit <= 'f') ? (Digit - 'a' + 10) :
+                               (Digit >= 'A' && Digit <= 'F') ? (Digit - 'A' + 10) : 0;
+                CodePoint = CodePoint * (IsHex ? 16 : 10) + Value;
+            }
+
+            if (CodePoint < 0x80)
+                Out += (char) CodePoint;
+            else if (CodePoint < 0x800)
+            {
+                Out += (char) (0xC0 | (CodePoint >> 6));
+                Out += (char) (0x80 | (CodePoint & 0x3F));
+            }
+            else if (CodePoint < 0x10000)
+            {
+                Out += (char) (0xE0 | (CodePoint >> 12));
+                Out += (char) (0x80 | ((CodePoint >> 6) & 0x3F));
+                Out += (char) (0x80 | (CodePoint & 0x3F));
+            }
+            else
+            {
+                Out += (char) (0xF0 | (CodePoint >> 18));
+                Out += (char) (0x80 | ((CodePoint >> 12) & 0x3F));
+                Out += (char) (0x80 | ((CodePoint >> 6) & 0x3F));
+                Out += (char) (0x80 | (CodePoint & 0x3F));
+            }
+        }
+
+        else
+        {
+            // Unknown entity; keep it as-is
+            Out += Chr;
+            continue;
+        }
+
+        Offset = EntityEnd + 1;
+    }
+
+    return Out;
+}
@@ -2,137 +2,75 @@
 #define CXMLREADER
 
 #include "IArchive.h"
-#include "XMLCommon.h"
-#include <tinyxml2.h>
-
+#include "Common/FileIO/IInputStream.h"
+#include <unordered_map>
+
+/**
+ * Pull parser over the raw XML text. No DOM is built; the reader only keeps the stack of
+ * elements it is currently inside and walks forward through the file as parameters are
+ * requested. Files are memory-mapped, and other streams are read through a small sliding
+ * window. A parameter requested out of order is found by scanning the parent's children
+ * once and keeping a name -> offset index for that parent so later misses are a lookup.
+ */
 class CXMLReader : public IArchive
 {
-    tinyxml2::XMLDocument mDoc;
-    tinyxml2::XMLElement *mpCurElem; // Points to the next element being read
-    const char* mpAttribute; // Name of the parameter we are reading from an attribute
-    bool mJustEndedParam; // Indicates we just ended a primitive parameter
-
-public:
-    CXMLReader(const TString& rkFileName)
-        : IArchive()
-        , mpAttribute(nullptr)
-        , mJustEndedParam(false)
+    struct SXMLAttribute
     {
-        mArchiveFlags = AF_Reader | AF_Text;
+        uint64 NameOffset;
+        uint64 ValueOffset;
+        uint32 NameLength;
+        uint32 ValueLength;
+    };
 
-        // Load XML and set current element to the root element; read version
-        tinyxml2::XMLError Error = mDoc.LoadFile(*rkFileName);
+    struct SXMLElement
+    {
+        uint64 ContentOffset;   // Just past the start tag
+        uint64 NextChildOffset; // Where to look for the next child parameter
+        bool IsEmpty;           // Self-closing tag, no content or end tag
+        bool IsIndexed;         // ChildIndex holds every child of this element
+        std::vector<SXMLAttribute> Attributes;
+        std::unordered_map<uint32, uint64> ChildIndex; // Name hash -> offset of the first child with that name
+    };
+
+    // Element stack; entries past mDepth are kept around so their containers can be reused
+    std::vector<SXMLElement> mElemStack;
+    uint32 mDepth;
+    int32 mAttribute; // Index of the attribute being read, or -1 if we're not reading an attribute
+
+    IInputStream *mpStream;
+    bool mOwnsStream;
+
+    // Addressable window of the file. Covers the entire file for memory-backed streams.
+    const char *mpWindow;
+    uint64 mWindowOffset;
+    uint64 mWindowSize;
+    uint64 mDataSize;
+    std::vector<char> mWindowBuffer;
 
-        if (Error != tinyxml2::XML_SUCCESS)
-        {
-            errorf("%s: Failed to open XML for read: %s", *rkFileName, XMLErrorString(Error));
-        }
-        else
-        {
-            mpCurElem = mDoc.FirstChildElement();
-            ASSERT( mpCurElem != nullptr );
-            SerializeVersion();
-        }
-    }
+public:
+    CXMLReader(const TString& rkFileName);
+    CXMLReader(IInputStream *pStream);
+    ~CXMLReader();
 
     inline bool IsValid() const
     {
-        return mpCurElem != nullptr;
+        return mDepth > 0;
     }
 
     // Interface
-    virtual bool IsReader() const       { return true; }
-    virtual bool IsWriter() const       { return false; }
-    virtual bool IsTextFormat() const   { return true; }
-
-    virtual bool ParamBegin(const char *pkName, uint32 Flags)
-    {
-        ASSERT(IsValid());
-        ASSERT(!mpAttribute); // Attributes cannot have sub-children
-
-        // Store as an attribute if requested
-        if (Flags & SH_Attribute)
-        {
-            mpAttribute = mpCurElem->Attribute(pkName);
-            return mpAttribute != nullptr;
-        }
-
-        // Push new parent if needed
-        if (!mJustEndedParam)
-        {
-            tinyxml2::XMLElement *pChild = mpCurElem->FirstChildElement();
-            if (!pChild) return false;
-            else mpCurElem = pChild;
-        }
-
-        // Verify the current element matches the name of the next serialized parameter.
-        if ( (Flags & SH_IgnoreName) || strcmp(mpCurElem->Name(), pkName) == 0 )
-        {
-            mJustEndedParam = false;
-            return true;
-        }
-
-        // It didn't match, so we'll try to find a sibling element that does match.
-        // Iterate over all sibling elements - if we find a match we will continue
-        // reading from that point on. Otherwise we can't load this parameter.
-        tinyxml2::XMLElement *pSearchElem = mpCurElem->Parent()->FirstChildElement();
-
-        while (pSearchElem)
-        {
-            if ( strcmp(pSearchElem->Name(), pkName) == 0 )
-            {
-                mpCurElem = pSearchElem;
-                mJustEndedParam = false;
-                return true;
-            }
-
-            pSearchElem = pSearchElem->NextSiblingElement();
-        }
-
-        // We couldn't find a matching element, so we can't load this parameter.
-        // If we pushed a parent earlier, undo it.
-        if (!mJustEndedParam)
-            mpCurElem = mpCurElem->Parent()->ToElement();
-
-        return false;
-    }
-
-    virtual void ParamEnd()
-    {
-        if (mpAttribute)
-            mpAttribute = nullptr;
-
-        else
-        {
-            if (mJustEndedParam)
-                mpCurElem = mpCurElem->Parent()->ToElement();
-
-            tinyxml2::XMLElement *pElem = mpCurElem->NextSiblingElement();
-            if (pElem)
-                mpCurElem = pElem;
-
-            mJustEndedParam = true;
-        }
-    }
+    virtual bool ParamBegin(const char *pkName, uint32 Flags);
+    virtual bool ParamBegin(const char *pkName, uint32 NameHash, uint32 Flags);
+    virtual void ParamEnd();
 
 protected:
-    TString ReadParam()
-    {
-        return TString( mpAttribute ? mpAttribute : mpCurElem->GetText() );
-    }
+    TString ReadParam();
 
 public:
-    virtual void SerializeArraySize(uint32& Value)
-    {
-        Value = 0;
-
-        for (tinyxml2::XMLElement *pElem = mpCurElem->FirstChildElement(); pElem; pElem = pElem->NextSiblingElement())
-            Value++;
-    }
+    virtual void SerializeArraySize(uint32& Value);
 
     virtual bool PreSerializePointer(void*& InPointer, uint32 Flags)
     {
-        return mpCurElem->GetText() == nullptr || strcmp(mpCurElem->GetText(), "NULL") != 0;
+        return ReadParam() != "NULL";
     }
 
     virtual void SerializePrimitive(bool& rValue, uint32 Flags)         { rValue = (ReadParam() == "true" ? true : false); }
@@ -163,7 +101,34 @@ public:
             pCharData++;
         }
     }
+
+private:
+    void Init();
+
+    // Character access
+    inline char CharAt(uint64 Offset)
+    {
+        if (Offset - mWindowOffset < mWindowSize || FillWindow(Offset))
+            return mpWindow[Offset - mWindowOffset];
+        else
+            return '\0';
+    }
+
+    bool FillWindow(uint64 Offset);
+    uint64 FindChar(uint64 Offset, char Chr);
+    uint64 FindString(uint64 Offset, const char *pkString);
+    bool MatchString(uint64 Offset, const char *pkString);
+
+    // Parsing
+    bool FindNextTag(uint64& rOffset);
+    bool FindChildTag(uint64& rOffset);
+    uint64 SkipStartTag(uint64 Offset, bool& rOutIsEmpty);
+    uint64 SkipContent(uint64 Offset);
+    uint64 SkipElement(uint64 Offset);
+    bool EnterElement(uint64 Offset);
+    bool NameMatches(uint64 Offset, const char *pkName);
+    uint32 HashName(uint64 Offset);
+    TString DecodeText(uint64 Offset, uint64 End);
 };
 
 #endif // CXMLREADER
-
@@ -0,0 +1,265 @@
+#include "CXMLWriter.h"
+#include "Common/FileIO/CFileOutStream.h"
+#include <cstring>
+
+static const char* XMLEntity(char Chr, bool IsAttribute)
+{
+    switch (Chr)
+    {
+    case '&':   return "&amp;";
+    case '<':   return "&lt;";
+    case '>':   return "&gt;";
+    case '"':   return IsAttribute ? "&quot;" : nullptr;
+    default:    return nullptr;
+    }
+}
+
+CXMLWriter::CXMLWriter(const TString& rkFileName, const TString& rkRootName, uint16 FileVersion /*= 0*/, EGame Game /*= EGame::Invalid*/)
+    : IArchive()
+    , mOwnsStream(true)
+    , mOutFilename(rkFileName)
+{
+    mpStream = new CFileOutStream(rkFileName);
+    Init(rkRootName, FileVersion, Game);
+}
+
+CXMLWriter::CXMLWriter(IOutputStream *pStream, const TString& rkRootName, uint16 FileVersion /*= 0*/, EGame Game /*= EGame::Invalid*/)
+    : IArchive()
+    , mpStream(pStream)
+    , mOwnsStream(false)
+    , mOutFilename(pStream->GetDestString())
+{
+    ASSERT(pStream && pStream->IsValid());
+    Init(rkRootName, FileVersion, Game);
+}
+
+CXMLWriter::~CXMLWriter()
+{
+    if (!mSaved)
+    {
+        bool SaveSuccess = Save();
+        ASSERT(SaveSuccess);
+    }
+}
+
+bool CXMLWriter::Save()
+{
+    if (mSaved)
+    {
+        errorf("Attempted to save XML twice!");
+        return false;
+    }
+
+    // Finish the root element. Unlike other elements it is written even if it's empty.
+    ASSERT(mElemStack.size() == 1);
+
+    if (mNumOpenTagsWritten == 0)
+        FlushOpenTags(true);
+    else
+    {
+        if (!mElemStack[0].HasText) WriteIndent(0);
+        Write("</", 2);
+        Write(mNameBuffer.data(), (uint32) mNameBuffer.size() - 1);
+        Write(">", 1);
+    }
+
+    Write("\n", 1);
+    bool Success = mpStream->IsValid() && !mMisplacedAttribute;
+    mSaved = true;
+
+    if (mOwnsStream)
+    {
+        delete mpStream;
+        mpStream = nullptr;
+    }
+
+    if (!Success)
+    {
+        errorf("Failed to save XML file: %s", *mOutFilename);
+        return false;
+    }
+    else
+        return true;
+}
+
+bool CXMLWriter::ParamBegin(const char *pkName, uint32 Flags)
+{
+    ASSERT(IsValid());
+    ASSERT(!mpAttributeName); // Attributes cannot have sub-children
+
+    // Write as attribute if needed
+    if (Flags & SH_Attribute)
+        mpAttributeName = pkName;
+    else
+        PushElement(pkName);
+
+    return true;
+}
+
+void CXMLWriter::ParamEnd()
+{
+    if (mpAttributeName)
+    {
+        mpAttributeName = nullptr;
+        return;
+    }
+
+    ASSERT(mElemStack.size() > 1);
+    const SXMLElement& rkElem = mElemStack.back();
+    uint32 Depth = mElemStack.size() - 1;
+
+    if (mNumOpenTagsWritten <= Depth)
+    {
+        // The open tag is still pending, so there's no text or children. If we didn't
+        // save any attributes either, the element is dropped; otherwise it self-closes.
+        if (rkElem.HasAttributes)
+            FlushOpenTags(true);
+        else
+            mPendingTags.resize(rkElem.TagOffset);
+    }
+    else
+    {
+        if (!rkElem.HasText) WriteIndent(Depth);
+        Write("</", 2);
+        Write(mNameBuffer.data() + rkElem.NameOffset, (uint32) (mNameBuffer.size() - rkElem.NameOffset - 1));
+        Write(">", 1);
+    }
+
+    mNameBuffer.resize(rkElem.NameOffset);
+    mElemStack.pop_back();
+
+    if (mNumOpenTagsWritten > mElemStack.size())
+        mNumOpenTagsWritten = mElemStack.size();
+}
+
+void CXMLWriter::WriteParam(const char *pkValue)
+{
+    if (mpAttributeName)
+        AppendAttribute(mpAttributeName, pkValue);
+    else
+    {
+        FlushOpenTags(false);
+        WriteText(pkValue);
+        mElemStack.back().HasText = true;
+    }
+}
+
+// ************ PRIVATE ************
+void CXMLWriter::Init(const TString& rkRootName, uint16 FileVersion, EGame Game)
+{
+    mArchiveFlags = AF_Writer | AF_Text;
+    mNumOpenTagsWritten = 0;
+    mpAttributeName = nullptr;
+    mMisplacedAttribute = false;
+    mSaved = false;
+    SetVersion(skCurrentArchiveVersion, FileVersion, Game);
+
+    // Write declaration and start root node
+    static const char skDeclaration[] = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>";
+    Write(skDeclaration, sizeof(skDeclaration) - 1);
+    PushElement(*rkRootName);
+
+    // Write version data
+    SerializeVersion();
+}
+
+void CXMLWriter::PushElement(const char *pkName)
+{
+    // The open tag isn't written until we know whether the element has any content
+    SXMLElement Elem;
+    Elem.NameOffset = mNameBuffer.size();
+    Elem.TagOffset = mPendingTags.size();
+    Elem.HasAttributes = false;
+    Elem.HasText = false;
+    mElemStack.push_back(Elem);
+
+    mNameBuffer.append(pkName);
+    mNameBuffer.push_back('\0');
+
+    mPendingTags.push_back('\n');
+    mPendingTags.append((mElemStack.size() - 1) * 4, ' ');
+    mPendingTags.push_back('<');
+    mPendingTags.append(pkName);
+}
+
+void CXMLWriter::FlushOpenTags(bool SelfCloseTop)
+{
+    // Writes the pending open tags of the current element and all of its ancestors
+    for (uint32 ElemIdx = mNumOpenTagsWritten; ElemIdx < mElemStack.size(); ElemIdx++)
+    {
+        bool IsTop = (ElemIdx == mElemStack.size() - 1);
+        uint32 Start = mElemStack[ElemIdx].TagOffset;
+        uint32 End = (IsTop ? mPendingTags.size() : mElemStack[ElemIdx + 1].TagOffset);
+
+        Write(mPendingTags.data() + Start, End - Start);
+
+        if (IsTop && SelfCloseTop)
+            Write("/>", 2);
+        else
+            Write(">", 1);
+    }
+
+    mPendingTags.clear();
+    mNumOpenTagsWritten = mElemStack.size();
+}
+
+void CXMLWriter::WriteIndent(uint32 Depth)
+{
+    static const char skIndent[] = "\n                                ";
+    static const uint32 skMaxDepth = (sizeof(skIndent) - 2) / 4;
+    Write(skIndent, 1);
+
+    for (; Depth > skMaxDepth; Depth -= skMaxDepth)
+        Write(skIndent + 1, skMaxDepth * 4);
+
+    Write(skIndent + 1, Depth * 4);
+}
+
+void CXMLWriter::WriteText(const char *pkText)
+{
+    // Writes runs of plain text in one go, breaking only for characters that need escaping
+    const char *pkRunStart = pkText;
+
+    for (; *pkText; pkText++)
+    {
+        const char *pkEntity = XMLEntity(*pkText, false);
+
+        if (pkEntity)
+        {
+            Write(pkRunStart, (uint32) (pkText - pkRunStart));
+            Write(pkEntity, (uint32) strlen(pkEntity));
+            pkRunStart = pkText + 1;
+        }
+    }
+
+    Write(pkRunStart, (uint32) (pkText - pkRunStart));
+}
+
+void CXMLWriter::AppendAttribute(const char *pkName, const char *pkValue)
+{
+    // Attributes go in the open tag, so they can't be added once it's been written
+    if (mNumOpenTagsWritten == mElemStack.size())
+    {
+        errorf("%s: Attribute %s was written after the content of element %s", *mOutFilename, pkName, mNameBuffer.data() + mElemStack.back().NameOffset);
+        mMisplacedAttribute = true;
+        ASSERT(false);
+        return;
+    }
+
+    mPendingTags.push_back(' ');
+    mPendingTags.append(pkName);
+    mPendingTags.append("=\"");
+
+    for (; *pkValue; pkValue++)
+    {
+        const char *pkEntity = XMLEntity(*pkValue, true);
+
+        if (pkEntity)
+            mPendingTags.append(pkEntity);
+        else
+            mPendingTags.push_back(*pkValue);
+    }
+
+    mPendingTags.push_back('"');
+    mElemStack.back().HasAttributes = true;
+}
@@ -3,130 +3,65 @@
 
 #include "IArchive.h"
 #include "Common/CFourCC.h"
-#include <iostream>
-#include <tinyxml2.h>
-
+#include "Common/FileIO/IOutputStream.h"
+#include <string>
+
+/**
+ * Writes XML straight to an output stream as parameters begin and end. Only the open tags of
+ * elements that haven't received any content yet are held back, since attributes still need to
+ * go in them and elements that end up empty are left out of the file entirely. Memory use is
+ * proportional to the nesting depth rather than the size of the document.
+ *
+ * Because of that, an element's attributes (including SerializeClassVersion) need to be serialized
+ * before any of its child elements or text. An attribute that comes too late can't be written; it
+ * fails an assert and leaves the writer invalid, so Save() fails instead of writing a file without it.
+ */
 class CXMLWriter : public IArchive
 {
-    tinyxml2::XMLDocument mDoc;
-    tinyxml2::XMLElement *mpCurElem;
+    struct SXMLElement
+    {
+        uint32 NameOffset;  // Offset of the element name in mNameBuffer
+        uint32 TagOffset;   // Offset of the open tag in mPendingTags, while it hasn't been written yet
+        bool HasAttributes;
+        bool HasText;
+    };
+    std::vector<SXMLElement> mElemStack;
+    uint32 mNumOpenTagsWritten;
+
+    std::string mNameBuffer;  // Null-separated names of the elements on the stack
+    std::string mPendingTags; // Open tags that haven't been written yet, without the closing '>'
+
+    IOutputStream *mpStream;
+    bool mOwnsStream;
     TString mOutFilename;
     const char* mpAttributeName;
+    bool mMisplacedAttribute;
     bool mSaved;
 
 public:
-    CXMLWriter(const TString& rkFileName, const TString& rkRootName, uint16 FileVersion = 0, EGame Game = EGame::Invalid)
-        : IArchive()
-        , mOutFilename(rkFileName)
-        , mpAttributeName(nullptr)
-        , mSaved(false)
-    {
-        mArchiveFlags = AF_Writer | AF_Text;
-        SetVersion(skCurrentArchiveVersion, FileVersion, Game);
-
-        // Create declaration and root node
-        tinyxml2::XMLDeclaration *pDecl = mDoc.NewDeclaration();
-        mDoc.LinkEndChild(pDecl);
-
-        mpCurElem = mDoc.NewElement(*rkRootName);
-        mDoc.LinkEndChild(mpCurElem);
-
-        // Write version data
-        SerializeVersion();
-    }
-
-    ~CXMLWriter()
-    {
-        if (!mSaved)
-        {
-            bool SaveSuccess = Save();
-            ASSERT(SaveSuccess);
-        }
-    }
-
-    inline bool Save()
-    {
-        if (mSaved)
-        {
-            errorf("Attempted to save XML twice!");
-            return false;
-        }
-
-        tinyxml2::XMLError Error = mDoc.SaveFile(*mOutFilename);
-        mSaved = true;
-
-        if (Error != tinyxml2::XML_SUCCESS)
-        {
-            errorf("Failed to save XML file: %s", *mOutFilename);
-            return false;
-        }
-        else
-            return true;
-    }
+    CXMLWriter(const TString& rkFileName, const TString& rkRootName, uint16 FileVersion = 0, EGame Game = EGame::Invalid);
+    CXMLWriter(IOutputStream *pStream, const TString& rkRootName, uint16 FileVersion = 0, EGame Game = EGame::Invalid);
+    ~CXMLWriter();
+    bool Save();
 
     inline bool IsValid() const
     {
-        return mpCurElem != nullptr && !mSaved;
+        return !mSaved && !mMisplacedAttribute && mpStream->IsValid();
     }
 
     // Interface
-    virtual bool ParamBegin(const char *pkName, uint32 Flags)
-    {
-        ASSERT(IsValid());
-        ASSERT(!mpAttributeName); // Attributes cannot have sub-children
-
-        // Read as attribute if needed
-        if (Flags & SH_Attribute)
-        {
-            mpAttributeName = pkName;
-        }
-        else
-        {
-            tinyxml2::XMLElement *pElem = mDoc.NewElement(pkName);
-            mpCurElem->LinkEndChild(pElem);
-            mpCurElem = pElem;
-        }
-
-        return true;
-    }
-
-    virtual void ParamEnd()
-    {
-        if (mpAttributeName)
-        {
-            mpAttributeName = nullptr;
-        }
-        else
-        {
-            // If we didn't save any sub parameters, remove the element.
-            tinyxml2::XMLElement* pParent = mpCurElem->Parent()->ToElement();
-
-            if ( mpCurElem->FirstAttribute() == nullptr
-                 && mpCurElem->FirstChild() == nullptr
-                 && mpCurElem->GetText() == nullptr )
-            {
-                pParent->DeleteChild(mpCurElem);
-            }
-
-            mpCurElem = pParent;
-        }
-    }
+    virtual bool ParamBegin(const char *pkName, uint32 Flags);
+    virtual void ParamEnd();
 
 protected:
-    void WriteParam(const char *pkValue)
-    {
-        if (mpAttributeName)
-            mpCurElem->SetAttribute(mpAttributeName, pkValue);
-        else
-            mpCurElem->SetText(pkValue);
-    }
+    void WriteParam(const char *pkValue);
 
 public:
     virtual bool PreSerializePointer(void*& Pointer, uint32 Flags)
     {
         if (!Pointer)
         {
-            mpCurElem->SetText("NULL");
+            WriteParam("NULL");
             return false;
         }
         return true;
@@ -155,17 +90,31 @@ public:
 
     virtual void SerializeBulkData(void* pData, uint32 Size, uint32 Flags)
     {
-        char* pCharData = (char*) pData;
+        static const char skHexDigits[] = "0123456789ABCDEF";
+        const uint8* pkByteData = (const uint8*) pData;
         TString OutString(Size*2);
 
         for (uint32 ByteIdx = 0; ByteIdx < Size; ByteIdx++)
         {
-            //@todo: sloooooow. maybe replace with a LUT?
-            sprintf(&OutString[ByteIdx*2], "%02X", pCharData[ByteIdx]);
+            OutString[ByteIdx*2]     = skHexDigits[pkByteData[ByteIdx] >> 4];
+            OutString[ByteIdx*2 + 1] = skHexDigits[pkByteData[ByteIdx] & 0xF];
         }
 
         WriteParam(*OutString);
     }
+
+private:
+    void Init(const TString& rkRootName, uint16 FileVersion, EGame Game);
+    void PushElement(const char *pkName);
+    void FlushOpenTags(bool SelfCloseTop);
+    void WriteIndent(uint32 Depth);
+    void WriteText(const char *pkText);
+    void AppendAttribute(const char *pkName, const char *pkValue);
+
+    inline void Write(const char *pkText, uint32 Length)
+    {
+        mpStream->WriteBytes(pkText, Length);
+    }
 };
 
 #endif // CXMLWRITER
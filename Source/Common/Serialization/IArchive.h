@@ -7,6 +7,7 @@
 #include "Common/CAssetID.h"
 #include "Common/CFourCC.h"
 #include "Common/EGame.h"
+#include "Common/Hash/CCRC32.h"
 #include "Common/TString.h"
 
 #include <type_traits>
@@ -44,6 +45,18 @@
  * the hood. For a list of possible hints, check the definition of ESerialHint.
  */
 
+/** Whether IArchive keeps full parameter stack entries (type, size and address of each parameter) to
+ *  validate the stack. Costs RTTI and extra stack traffic per parameter, so it's debug-only by default.
+ *  Must be the same in every translation unit, since it changes the layout of IArchive.
+ */
+#ifndef ARCHIVE_FULL_PARAM_STACK
+    #if _DEBUG
+        #define ARCHIVE_FULL_PARAM_STACK 1
+    #else
+        #define ARCHIVE_FULL_PARAM_STACK 0
+    #endif
+#endif
+
 /** ESerialHint - Parameter hint flags */
 enum ESerialHint
 {
@@ -68,11 +81,41 @@ enum EArchiveFlags
     AF_Text                 = 0x4,      // Archive reads/writes to a text format.
     AF_Binary               = 0x8,      // Archive reads/writes to a binary format.
     AF_NoSkipping           = 0x10,     // Properties are never skipped.
+    AF_BulkScalars          = 0x20,     // Bulk serial types are serialized straight from memory instead of through their Serialize function.
 };
 
 /** Shortcut macro for enable_if */
 #define ENABLE_IF(Conditions, ReturnType) typename std::enable_if< Conditions, ReturnType >::type
 
+/** TBulkSerialTraits - Describes types whose Serialize function covers nothing but a run of NumScalars
+ *  values of ScalarType at the start of the object, in memory order. In archives with AF_BulkScalars,
+ *  these are serialized as a flat scalar array. Use DECLARE_BULK_SERIAL_TYPE after the class to opt in.
+ */
+template<typename T>
+struct TBulkSerialTraits
+{
+    static const bool IsBulk = false;
+    static const bool IsPacked = false;
+};
+
+#define DECLARE_BULK_SERIAL_TYPE(Type, Scalar, Count) \
+    template<> struct TBulkSerialTraits<Type> \
+    { \
+        static const bool IsBulk = true; \
+        using ScalarType = Scalar; \
+        static const uint32 NumScalars = Count; \
+        static const bool IsPacked = (sizeof(Type) == sizeof(Scalar) * Count); /* Arrays of the type are one contiguous run of scalars */ \
+    };
+
+DECLARE_BULK_SERIAL_TYPE(int16, int16, 1)
+DECLARE_BULK_SERIAL_TYPE(uint16, uint16, 1)
+DECLARE_BULK_SERIAL_TYPE(int32, int32, 1)
+DECLARE_BULK_SERIAL_TYPE(uint32, uint32, 1)
+DECLARE_BULK_SERIAL_TYPE(int64, int64, 1)
+DECLARE_BULK_SERIAL_TYPE(uint64, uint64, 1)
+DECLARE_BULK_SERIAL_TYPE(float, float, 1)
+DECLARE_BULK_SERIAL_TYPE(double, double, 1)
+
 /** Check for whether the equality operator has been implemented for a given type */
 template<typename ValType, class = decltype(std::declval<ValType>() == std::declval<ValType>())>
 std::true_type  THasEqualToOperator(const ValType&);
@@ -95,11 +138,26 @@ template<typename T>    struct TIsSmartPointer< std::unique_ptr<T> > : public st
 /** Helper macro that tells us whether the parameter supports default property values */
 #define SUPPORTS_DEFAULT_VALUES (!std::is_pointer_v<ValType> && std::is_copy_assignable_v<ValType> && THasEqualTo<ValType>::value && !TIsContainer<ValType>::value && !TIsSmartPointer<ValType>::value)
 
+/** SSerialName - parameter name with its CRC32 computed at compile time. Create with SERIAL_NAME. */
+struct SSerialName
+{
+    const char*         pkName;
+    uint32              Hash;
+};
+
+/**
+ * Hashes a string literal parameter name at compile time, for hot code serialized to binary archives:
+ *   SerialParameter(SERIAL_NAME("Name"), Value)
+ * Passing the hash as a template argument is what forces it to be evaluated by the compiler.
+ */
+#define SERIAL_NAME(Name) SSerialName { Name, std::integral_constant<uint32, CCRC32::StaticHashString(Name)>::value }
+
 /** TSerialParameter - name/value pair for generic serial parameters */
 template<typename ValType>
 struct TSerialParameter
 {
     const char*         pkName;
+    uint32              NameHash;       // 0 if the name wasn't hashed up front; archives that need the hash compute it themselves
     ValType&            rValue;
     uint32              HintFlags;
     const ValType*      pDefaultValue;
@@ -110,13 +168,27 @@ template<typename ValType>
 ENABLE_IF( SUPPORTS_DEFAULT_VALUES, TSerialParameter<ValType> )
 inline SerialParameter(const char* pkName, ValType& rValue, uint32 HintFlags = 0, const ValType& rkDefaultValue = ValType())
 {
-    return TSerialParameter<ValType> { pkName, rValue, HintFlags, &rkDefaultValue };
+    return TSerialParameter<ValType> { pkName, 0, rValue, HintFlags, &rkDefaultValue };
 }
 template<typename ValType>
 ENABLE_IF( !SUPPORTS_DEFAULT_VALUES, TSerialParameter<ValType> )
 inline SerialParameter(const char* pkName, ValType& rValue, uint32 HintFlags = 0)
 {
-    return TSerialParameter<ValType> { pkName, rValue, HintFlags, nullptr };
+    return TSerialParameter<ValType> { pkName, 0, rValue, HintFlags, nullptr };
+}
+
+/** Creates a SerialParameter with a precomputed name hash */
+template<typename ValType>
+ENABLE_IF( SUPPORTS_DEFAULT_VALUES, TSerialParameter<ValType> )
+inline SerialParameter(SSerialName Name, ValType& rValue, uint32 HintFlags = 0, const ValType& rkDefaultValue = ValType())
+{
+    return TSerialParameter<ValType> { Name.pkName, Name.Hash, rValue, HintFlags, &rkDefaultValue };
+}
+template<typename ValType>
+ENABLE_IF( !SUPPORTS_DEFAULT_VALUES, TSerialParameter<ValType> )
+inline SerialParameter(SSerialName Name, ValType& rValue, uint32 HintFlags = 0)
+{
+    return TSerialParameter<ValType> { Name.pkName, Name.Hash, rValue, HintFlags, nullptr };
 }
 
 /** Returns whether the parameter value matches its default value */
@@ -318,12 +390,15 @@ protected:
     // Subclasses must fill in flags in their constructors!!!
     uint32 mArchiveFlags;
 
-    // Info about the stack of parameters being serialized
+    // Info about the stack of parameters being serialized. Release builds only keep the hint flags,
+    // which are needed for hint inheritance; the rest is only used to validate the stack.
     struct SParmStackEntry
     {
+#if ARCHIVE_FULL_PARAM_STACK
         size_t TypeID;
         size_t TypeSize;
         void* pDataPointer;
+#endif
         uint32 HintFlags;
     };
     std::vector<SParmStackEntry> mParmStack;
@@ -336,6 +411,7 @@ public:
         eArVer_Refactor,
         eArVer_MapAttributes,
         eArVer_GameEnumClass,
+        eArVer_BulkVectors,
         // Insert new versions before this line
         eArVer_Max
     };
@@ -356,9 +432,9 @@ public:
     // Serialize archive version. Always call after opening a file.
     void SerializeVersion()
     {
-        *this << SerialParameter("ArchiveVer",  mArchiveVersion,    SH_Attribute)
-              << SerialParameter("FileVer",     mFileVersion,       SH_Attribute | SH_Optional,     (uint16) 0)
-              << SerialParameter("Game",        mGame,              SH_Attribute | SH_Optional,     EGame::Invalid);
+        *this << SerialParameter(SERIAL_NAME("ArchiveVer"),  mArchiveVersion,    SH_Attribute)
+              << SerialParameter(SERIAL_NAME("FileVer"),     mFileVersion,       SH_Attribute | SH_Optional,     (uint16) 0)
+              << SerialParameter(SERIAL_NAME("Game"),        mGame,              SH_Attribute | SH_Optional,     EGame::Invalid);
 
         if (IsReader())
         {
@@ -374,8 +450,11 @@ private:
     template<typename ValType>
     bool InternalStartParam(const TSerialParameter<ValType>& Param)
     {
+        // Without a precomputed hash, only archives that actually look params up by hash pay for it.
+        // A name that really hashes to 0 just takes the slower path.
         bool IsProxy = (Param.HintFlags & SH_Proxy) != 0;
-        return ShouldSerializeParameter(Param) && (IsProxy || ParamBegin(Param.pkName, Param.HintFlags) );
+        return ShouldSerializeParameter(Param) && (IsProxy || (Param.NameHash != 0 ? ParamBegin(Param.pkName, Param.NameHash, Param.HintFlags)
+                                                                                   : ParamBegin(Param.pkName, Param.HintFlags)) );
     }
 
     // Ends a parameter.
@@ -442,7 +521,7 @@ private:
     template<typename ValType>
     inline void PushParameter(TSerialParameter<ValType>& Param)
     {
-#if _DEBUG
+#if ARCHIVE_FULL_PARAM_STACK
         if (mParmStack.size() > 0)
         {
             // Attribute properties cannot have children!
@@ -457,9 +536,11 @@ private:
         }
 
         SParmStackEntry Entry;
+#if ARCHIVE_FULL_PARAM_STACK
         Entry.TypeID = typeid(ValType).hash_code();
         Entry.TypeSize = sizeof(ValType);
         Entry.pDataPointer = &Param.rValue;
+#endif
         Entry.HintFlags = Param.HintFlags;
         mParmStack.push_back(Entry);
     }
@@ -467,7 +548,7 @@ private:
     template<typename ValType>
     inline void PopParameter(const TSerialParameter<ValType>& Param)
     {
-#if _DEBUG
+#if ARCHIVE_FULL_PARAM_STACK
         // Make sure the entry matches the param that has been passed in
         ASSERT(mParmStack.size() > 0);
         const SParmStackEntry& kEntry = mParmStack.back();
@@ -477,6 +558,14 @@ private:
         mParmStack.pop_back();
     }
 
+    // Fallback for archives that don't implement SerializeBulkScalars
+    template<typename ScalarType>
+    inline void SerializeScalarsIndividually(ScalarType* pData, uint32 Count, uint32 Flags)
+    {
+        for (uint32 i = 0; i < Count; i++)
+            SerializePrimitive(pData[i], Flags);
+    }
+
 public:
     // Serialize primitives
     template<typename ValType>
@@ -510,7 +599,7 @@ public:
             if (ArchiveVersion() < eArVer_Refactor && IsReader() && std::is_polymorphic_v<ValType>)
             {
                 uint32 Type;
-                *this << SerialParameter("Type", Type, SH_Attribute);
+                *this << SerialParameter(SERIAL_NAME("Type"), Type, SH_Attribute);
             }
 
             if (PreSerializePointer(rParam.rValue, rParam.HintFlags))
@@ -563,7 +652,7 @@ public:
             if (ArchiveVersion() < eArVer_Refactor && IsReader() && std::is_polymorphic_v<ValType>)
             {
                 uint32 Type;
-                *this << SerialParameter("Type", Type, SH_Attribute);
+                *this << SerialParameter(SERIAL_NAME("Type"), Type, SH_Attribute);
             }
 
             if (PreSerializePointer(rParam.rValue, rParam.HintFlags, rParam.HintFlags))
@@ -593,7 +682,16 @@ public:
 
         if (InternalStartParam(rParam))
         {
-            rParam.rValue.Serialize(*this);
+            if constexpr (TBulkSerialTraits<ValType>::IsBulk)
+            {
+                if (CanSerializeBulkScalars())
+                    SerializeBulkScalars((typename TBulkSerialTraits<ValType>::ScalarType*) &rParam.rValue, TBulkSerialTraits<ValType>::NumScalars, rParam.HintFlags);
+                else
+                    rParam.rValue.Serialize(*this);
+            }
+            else
+                rParam.rValue.Serialize(*this);
+
             InternalEndParam(rParam);
         }
         else if (IsReader())
@@ -615,7 +713,7 @@ public:
             if (ArchiveVersion() < eArVer_Refactor && IsReader() && std::is_polymorphic_v<ValType>)
             {
                 uint32 Type;
-                *this << SerialParameter("Type", Type, SH_Attribute);
+                *this << SerialParameter(SERIAL_NAME("Type"), Type, SH_Attribute);
             }
 
             if (PreSerializePointer((void*&) rParam.rValue, rParam.HintFlags))
@@ -651,7 +749,7 @@ public:
                 if (IsWriter())
                 {
                     ObjectType Type = rParam.rValue->Type();
-                    *this << SerialParameter("Type", Type, SH_Attribute);
+                    *this << SerialParameter(SERIAL_NAME("Type"), Type, SH_Attribute);
                 }
                 else
                 {
@@ -659,7 +757,7 @@ public:
                     // It is legal to serialize a pointer that already exists, so you still need to initialize it.
                     ObjectType Type = (rParam.rValue ? rParam.rValue->Type() : ObjectType());
                     ObjectType TypeCopy = Type;
-                    *this << SerialParameter("Type", Type, SH_Attribute);
+                    *this << SerialParameter(SERIAL_NAME("Type"), Type, SH_Attribute);
 
                     if (IsReader() && rParam.rValue == nullptr)
                     {
@@ -712,6 +810,17 @@ public:
     virtual bool ParamBegin(const char *pkName, uint32 Flags) = 0;
     virtual void ParamEnd() = 0;
 
+    // ParamBegin with the CRC32 of the name precomputed with SERIAL_NAME. Archives that identify params by hash should override this.
+    virtual bool ParamBegin(const char *pkName, uint32 NameHash, uint32 Flags)
+    {
+        return ParamBegin(pkName, Flags);
+    }
+
+    inline bool ParamBegin(SSerialName Name, uint32 Flags)
+    {
+        return ParamBegin(Name.pkName, Name.Hash, Flags);
+    }
+
     virtual bool PreSerializePointer(void*& Pointer, uint32 Flags) = 0;
     virtual void SerializePrimitive(bool& rValue, uint32 Flags) = 0;
     virtual void SerializePrimitive(char& rValue, uint32 Flags) = 0;
@@ -730,10 +839,22 @@ public:
     virtual void SerializePrimitive(CAssetID& rValue, uint32 Flags) = 0;
     virtual void SerializeBulkData(void* pData, uint32 DataSize, uint32 Flags) = 0;
 
+    // Serialize an array of scalars with no parameters around them. Used for bulk serial types when AF_BulkScalars
+    // is set, and for vectors of them in binary archives (see CanSerializeBulkVectors). Overrides should fix up endianness in bulk.
+    virtual void SerializeBulkScalars(int16* pData, uint32 Count, uint32 Flags)     { SerializeScalarsIndividually(pData, Count, Flags); }
+    virtual void SerializeBulkScalars(int32* pData, uint32 Count, uint32 Flags)     { SerializeScalarsIndividually(pData, Count, Flags); }
+    virtual void SerializeBulkScalars(int64* pData, uint32 Count, uint32 Flags)     { SerializeScalarsIndividually(pData, Count, Flags); }
+    virtual void SerializeBulkScalars(float* pData, uint32 Count, uint32 Flags)     { SerializeScalarsIndividually(pData, Count, Flags); }
+    virtual void SerializeBulkScalars(double* pData, uint32 Count, uint32 Flags)    { SerializeScalarsIndividually(pData, Count, Flags); }
+
+    inline void SerializeBulkScalars(uint16* pData, uint32 Count, uint32 Flags)     { SerializeBulkScalars((int16*) pData, Count, Flags); }
+    inline void SerializeBulkScalars(uint32* pData, uint32 Count, uint32 Flags)     { SerializeBulkScalars((int32*) pData, Count, Flags); }
+    inline void SerializeBulkScalars(uint64* pData, uint32 Count, uint32 Flags)     { SerializeBulkScalars((int64*) pData, Count, Flags); }
+
     // Optional - serialize in an array size. By default, just stores size as an attribute property.
     virtual void SerializeArraySize(uint32& Value)
     {
-        *this << SerialParameter("Size", Value, SH_Attribute);
+        *this << SerialParameter(SERIAL_NAME("Size"), Value, SH_Attribute);
     }
 
     // Non-virtual primitive serialization
@@ -741,14 +862,14 @@ public:
     {
         TString String = (IsReader() ? "" : rValue.ToUTF8());
         SerializePrimitive(String, Flags);
-        if (IsWriter()) rValue = String.ToUTF16();
+        if (IsReader()) rValue = String.ToUTF16();
     }
 
     void SerializePrimitive(T32String& rValue, uint32 Flags)
     {
         TString String = (IsReader() ? "" : rValue.ToUTF8());
         SerializePrimitive(String, Flags);
-        if (IsWriter()) rValue = String.ToUTF32();
+        if (IsReader()) rValue = String.ToUTF32();
     }
 
     // Accessors
@@ -757,6 +878,14 @@ public:
     inline bool IsTextFormat() const            { return (mArchiveFlags & AF_Text) != 0; }
     inline bool IsBinaryFormat() const          { return (mArchiveFlags & AF_Binary) != 0; }
     inline bool CanSkipParameters() const       { return (mArchiveFlags & AF_NoSkipping) == 0; }
+    inline bool CanSerializeBulkScalars() const { return (mArchiveFlags & AF_BulkScalars) != 0; }
+
+    // Vectors of packed bulk serial types are written as one block of scalars in binary archives. Basic binary
+    // archives lay them out the same way either way; other binary archives only do it from eArVer_BulkVectors on.
+    inline bool CanSerializeBulkVectors() const
+    {
+        return CanSerializeBulkScalars() || (IsBinaryFormat() && mArchiveVersion >= eArVer_BulkVectors);
+    }
 
     inline uint16 ArchiveVersion() const    { return mArchiveVersion; }
     inline uint16 FileVersion() const       { return mFileVersion; }
@@ -784,7 +913,7 @@ public:
     /** Utility function for class versioning */
     uint32 SerializeClassVersion(uint32 CurrentVersion)
     {
-        *this << SerialParameter("ClassVer", CurrentVersion, SH_Attribute | SH_Optional, (uint32) 0);
+        *this << SerialParameter(SERIAL_NAME("ClassVer"), CurrentVersion, SH_Attribute | SH_Optional, (uint32) 0);
         return CurrentVersion;
     }
 };
@@ -842,10 +971,28 @@ inline void Serialize(IArchive& Arc, std::vector<T>& Vector)
         Vector.resize(Size);
     }
 
+    // Arrays of packed bulk serial types go through in one block, as long as the scalar count fits in 32 bits.
+    // Readers get the same count from the array size, so they take the same path.
+    if constexpr (TBulkSerialTraits<T>::IsPacked)
+    {
+        if (Arc.CanSerializeBulkVectors())
+        {
+            uint64 NumScalars = (uint64) Size * TBulkSerialTraits<T>::NumScalars;
+
+            if (NumScalars <= 0xFFFFFFFF)
+            {
+                Arc.SerializeBulkScalars((typename TBulkSerialTraits<T>::ScalarType*) Vector.data(), (uint32) NumScalars, 0);
+                return;
+            }
+
+            errorf("Vector of %d elements has too many scalars to serialize in bulk; serializing it one element at a time", Size);
+        }
+    }
+
     for (uint32 i = 0; i < Size; i++)
     {
         // SH_IgnoreName to preserve compatibility with older files that may have differently-named items
-        Arc << SerialParameter("Element", Vector[i], SH_InheritHints | SH_IgnoreName);
+        Arc << SerialParameter(SERIAL_NAME("Element"), Vector[i], SH_InheritHints | SH_IgnoreName);
     }
 }
 
@@ -855,7 +1002,7 @@ inline void Serialize(IArchive& Arc, std::vector<uint8>& Vector)
 {
     // Don't use SerializeArraySize, bulk data is a special case that overloads may not handle correctly
     uint32 Size = Vector.size();
-    Arc << SerialParameter("Size", Size, SH_Attribute);
+    Arc << SerialParameter(SERIAL_NAME("Size"), Size, SH_Attribute);
 
     if (Arc.IsReader())
     {
@@ -878,7 +1025,7 @@ inline void Serialize(IArchive& Arc, std::list<T>& List)
     }
 
     for (auto Iter = List.begin(); Iter != List.end(); Iter++)
-        Arc << SerialParameter("Element", *Iter, SH_IgnoreName | SH_InheritHints);
+        Arc << SerialParameter(SERIAL_NAME("Element"), *Iter, SH_IgnoreName | SH_InheritHints);
 }
 
 // std::set
@@ -893,8 +1040,8 @@ inline void Serialize(IArchive& Arc, std::set<T>& Set)
         for (uint32 i = 0; i < Size; i++)
         {
             T Val;
-            Arc << SerialParameter("Element", Val, SH_IgnoreName | SH_InheritHints);
-            Set.insert(Val);
+            Arc << SerialParameter(SERIAL_NAME("Element"), Val, SH_IgnoreName | SH_InheritHints);
+            Set.insert(std::move(Val));
         }
     }
 
@@ -902,13 +1049,25 @@ inline void Serialize(IArchive& Arc, std::set<T>& Set)
     {
         for (auto Iter = Set.begin(); Iter != Set.end(); Iter++)
         {
+            // Set elements are const; Serialize methods may still touch their parameter when writing, so go through a copy
             T Val = *Iter;
-            Arc << SerialParameter("Element", Val, SH_IgnoreName | SH_InheritHints);
+            Arc << SerialParameter(SERIAL_NAME("Element"), Val, SH_IgnoreName | SH_InheritHints);
         }
     }
 }
 
 // std::map and std::unordered_map
+template<typename MapType>
+inline void ReserveMap(MapType&, size_t)
+{
+}
+
+template<typename KeyType, typename ValType, typename HashFunc>
+inline void ReserveMap(std::unordered_map<KeyType, ValType, HashFunc>& Map, size_t Size)
+{
+    Map.reserve(Size);
+}
+
 template<typename KeyType, typename ValType, typename MapType>
 inline void SerializeMap_Internal(IArchive& Arc, MapType& Map)
 {
@@ -925,18 +1084,21 @@ inline void SerializeMap_Internal(IArchive& Arc, MapType& Map)
 
     if (Arc.IsReader())
     {
+        ReserveMap(Map, Map.size() + Size);
+
         for (uint32 i = 0; i < Size; i++)
         {
             KeyType Key;
             ValType Val;
 
-            if (Arc.ParamBegin("Element", SH_IgnoreName | SH_InheritHints))
+            if (Arc.ParamBegin(SERIAL_NAME("Element"), SH_IgnoreName | SH_InheritHints))
             {
-                Arc << SerialParameter("Key", Key, Hints)
-                    << SerialParameter("Value", Val, Hints);
+                Arc << SerialParameter(SERIAL_NAME("Key"), Key, Hints)
+                    << SerialParameter(SERIAL_NAME("Value"), Val, Hints);
 
-                ASSERT(Map.find(Key) == Map.end());
-                Map[Key] = Val;
+                // Duplicate keys shouldn't happen, but if they do, the last one wins
+                [[maybe_unused]] bool Inserted = Map.insert_or_assign(std::move(Key), std::move(Val)).second;
+                ASSERT(Inserted);
                 Arc.ParamEnd();
             }
         }
@@ -946,15 +1108,13 @@ inline void SerializeMap_Internal(IArchive& Arc, MapType& Map)
     {
         for (auto Iter = Map.begin(); Iter != Map.end(); Iter++)
         {
-            // Creating copies is not ideal, but necessary because parameters cannot be const.
-            // Maybe this can be avoided somehow?
+            // Keys are const for the same reason as set elements, so only the key is copied; the value is serialized in place
             KeyType Key = Iter->first;
-            ValType Val = Iter->second;
 
-            if (Arc.ParamBegin("Element", SH_IgnoreName | SH_InheritHints))
+            if (Arc.ParamBegin(SERIAL_NAME("Element"), SH_IgnoreName | SH_InheritHints))
             {
-                Arc << SerialParameter("Key", Key, Hints)
-                    << SerialParameter("Value", Val, Hints);
+                Arc << SerialParameter(SERIAL_NAME("Key"), Key, Hints)
+                    << SerialParameter(SERIAL_NAME("Value"), Iter->second, Hints);
 
                 Arc.ParamEnd();
             }
@@ -979,7 +1139,7 @@ template<typename T>
 void Serialize(IArchive& Arc, std::unique_ptr<T>& Pointer)
 {
     T* pRawPtr = Pointer.get();
-    Arc << SerialParameter("RawPointer", pRawPtr, SH_Proxy);
+    Arc << SerialParameter(SERIAL_NAME("RawPointer"), pRawPtr, SH_Proxy);
 
     if (Arc.IsReader())
         Pointer = std::unique_ptr<T>(pRawPtr);
@@ -989,7 +1149,7 @@ template<typename T>
 void Serialize(IArchive& Arc, std::shared_ptr<T>& Pointer)
 {
     T* pRawPtr = Pointer.get();
-    Arc << SerialParameter("RawPointer", pRawPtr, SH_Proxy);
+    Arc << SerialParameter(SERIAL_NAME("RawPointer"), pRawPtr, SH_Proxy);
 
     if (Arc.IsReader())
         Pointer = std::shared_ptr<T>(pRawPtr);
@@ -1171,6 +1171,43 @@ public:
     class T16String ToUTF16() const;
 };
 
+// ************ CStringView ************
+/** Non-owning view of a UTF-8 character range. Not necessarily null terminated.
+ *  Whoever hands one out determines how long the underlying data stays valid.
+ */
+class CStringView
+{
+    const char* mpkData;
+    uint32 mSize;
+
+public:
+    CStringView()
+        : mpkData(""), mSize(0)
+    {}
+    CStringView(const char* pkData, uint32 Size)
+        : mpkData(pkData), mSize(Size)
+    {}
+
+    inline const char* Data() const         { return mpkData; }
+    inline uint32 Size() const              { return mSize; }
+    inline bool IsEmpty() const             { return mSize == 0; }
+    inline char operator[](uint32 Idx) const { return mpkData[Idx]; }
+    inline TString ToString() const         { return TString(mpkData, mSize); }
+
+    inline bool operator==(const CStringView& rkOther) const
+    {
+        return mSize == rkOther.mSize && memcmp(mpkData, rkOther.mpkData, mSize) == 0;
+    }
+
+    inline bool operator==(const char* pkOther) const
+    {
+        return strlen(pkOther) == mSize && memcmp(mpkData, pkOther, mSize) == 0;
+    }
+
+    inline bool operator!=(const CStringView& rkOther) const    { return !(*this == rkOther); }
+    inline bool operator!=(const char* pkOther) const           { return !(*this == pkOther); }
+};
+
 // ************ CToWChar ************
 #define WCHAR_IS_16BIT WIN32
 
@@ -14,6 +14,9 @@ BUILD_DIR = $$PWD/../Build
 EXTERNALS_DIR = $$PWD/../Externals
 DESTDIR = $$BUILD_DIR
 
+# Override IArchive's parameter stack mode (see IArchive.h), e.g. qmake ARCHIVE_FULL_PARAM_STACK=1
+!isEmpty(ARCHIVE_FULL_PARAM_STACK): DEFINES += ARCHIVE_FULL_PARAM_STACK=$$ARCHIVE_FULL_PARAM_STACK
+
 win32: {
     QMAKE_CXXFLAGS += /WX \  # Treat warnings as errors
         /wd4267 \        # Disable C4267: conversion from 'size_t' to 'type', possible loss of data
@@ -75,14 +78,26 @@ HEADERS += \
     Common/Serialization/CBasicBinaryWriter.h \
     Common/Serialization/CBinaryReader.h \
     Common/Serialization/CBinaryWriter.h \
+    Common/Serialization/CBinaryTreeReader.h \
+    Common/Serialization/CBinaryTreeWriter.h \
     Common/Serialization/CSerialVersion.h \
     Common/Serialization/Binary.h \
+    Common/Serialization/BinaryCommon.h \
     Common/Serialization/XML.h \
     Common/FileIO/CBitStreamInWrapper.h \
+    Common/FileIO/CBitStreamOutWrapper.h \
+    Common/FileIO/CCompressedInStream.h \
+    Common/FileIO/CCompressedOutStream.h \
+    Common/FileIO/Compression.h \
     Common/FileIO/CFileInStream.h \
+    Common/FileIO/CMappedFileInStream.h \
+    Common/FileIO/CPrefetchFileInStream.h \
+    Common/FileIO/CSharedFileInStream.h \
     Common/FileIO/CFileOutStream.h \
     Common/FileIO/CMemoryInStream.h \
+    Common/FileIO/CSubInStream.h \
     Common/FileIO/CMemoryOutStream.h \
+    Common/FileIO/CSegmentedOutStream.h \
     Common/FileIO/CVectorOutStream.h \
     Common/FileIO/IInputStream.h \
     Common/FileIO/IOutputStream.h \
@@ -114,16 +129,29 @@ SOURCES += \
     Common/Log.cpp \
     Common/TString.cpp \
     Common/FileIO/CFileInStream.cpp \
+    Common/FileIO/CMappedFileInStream.cpp \
+    Common/FileIO/CPrefetchFileInStream.cpp \
+    Common/FileIO/CSharedFileInStream.cpp \
     Common/FileIO/CFileOutStream.cpp \
     Common/FileIO/CMemoryInStream.cpp \
+    Common/FileIO/CSubInStream.cpp \
     Common/FileIO/CMemoryOutStream.cpp \
+    Common/FileIO/CSegmentedOutStream.cpp \
     Common/FileIO/CVectorOutStream.cpp \
     Common/FileIO/IOUtil.cpp \
     Common/FileIO/IInputStream.cpp \
     Common/FileIO/IOutputStream.cpp \
     Common/FileIO/CBitStreamInWrapper.cpp \
+    Common/FileIO/CBitStreamOutWrapper.cpp \
+    Common/FileIO/CCompressedInStream.cpp \
+    Common/FileIO/CCompressedOutStream.cpp \
+    Common/FileIO/Compression.cpp \
     Common/Hash/CCRC32.cpp \
+    Common/Serialization/CBinaryTreeReader.cpp \
+    Common/Serialization/CBinaryTreeWriter.cpp \
     Common/Serialization/CSerialVersion.cpp \
+    Common/Serialization/CXMLReader.cpp \
+    Common/Serialization/CXMLWriter.cpp \
     Common/Math/CAABox.cpp \
     Common/Math/CFrustumPlanes.cpp \
     Common/Math/CMatrix4f.cpp \
@@ -135,6 +163,37 @@ SOURCES += \
     Common/Math/CVector4f.cpp \
     Common/Math/MathUtil.cpp
 
+# Optional compression codecs for CCompressedInStream/CCompressedOutStream.
+# Each codec found under Externals is compiled into LibCommon, so consumers don't need to link it separately.
+exists($$EXTERNALS_DIR/zlib/zlib.h) {
+    DEFINES += WITH_ZLIB
+    INCLUDEPATH += $$EXTERNALS_DIR/zlib
+    SOURCES += $$EXTERNALS_DIR/zlib/adler32.c \
+               $$EXTERNALS_DIR/zlib/compress.c \
+               $$EXTERNALS_DIR/zlib/crc32.c \
+               $$EXTERNALS_DIR/zlib/deflate.c \
+               $$EXTERNALS_DIR/zlib/inffast.c \
+               $$EXTERNALS_DIR/zlib/inflate.c \
+               $$EXTERNALS_DIR/zlib/inftrees.c \
+               $$EXTERNALS_DIR/zlib/trees.c \
+               $$EXTERNALS_DIR/zlib/uncompr.c \
+               $$EXTERNALS_DIR/zlib/zutil.c
+}
+
+exists($$EXTERNALS_DIR/lz4/lib/lz4.h) {
+    DEFINES += WITH_LZ4
+    INCLUDEPATH += $$EXTERNALS_DIR/lz4/lib
+    SOURCES += $$EXTERNALS_DIR/lz4/lib/lz4.c
+}
+
+exists($$EXTERNALS_DIR/zstd/lib/zstd.h) {
+    DEFINES += WITH_ZSTD
+    INCLUDEPATH += $$EXTERNALS_DIR/zstd/lib
+    SOURCES += $$files($$EXTERNALS_DIR/zstd/lib/common/*.c) \
+               $$files($$EXTERNALS_DIR/zstd/lib/compress/*.c) \
+               $$files($$EXTERNALS_DIR/zstd/lib/decompress/*.c)
+}
+
 # Codegen
 CODEGEN_DIR = $$EXTERNALS_DIR/CodeGen
 CODEGEN_OUT_PATH = $$BUILD_DIR/CodeGen/auto_codegen.cpp
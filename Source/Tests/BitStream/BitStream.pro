@@ -0,0 +1,37 @@
+#-------------------------------------------------
+#
+# Round-trip tests for CBitStreamOutWrapper against CBitStreamInWrapper.
+# Builds a console app that links LibCommon; it returns nonzero if any test fails.
+#
+#-------------------------------------------------
+
+QT -= core gui
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+BUILD_DIR = $$PWD/../../../Build
+EXTERNALS_DIR = $$PWD/../../../Externals
+DESTDIR = $$BUILD_DIR
+
+CONFIG (debug, debug|release) {
+    # Debug Config
+    OBJECTS_DIR = $$BUILD_DIR/debug/BitStreamTests
+    TARGET = BitStreamTestsd
+    LIBS += -L$$BUILD_DIR -lLibCommond
+}
+
+CONFIG (release, debug|release) {
+    # Release Config
+    OBJECTS_DIR = $$BUILD_DIR/release/BitStreamTests
+    TARGET = BitStreamTests
+    LIBS += -L$$BUILD_DIR -lLibCommon
+}
+
+# Include Paths
+INCLUDEPATH += $$PWD/../.. \
+               $$EXTERNALS_DIR/CodeGen/include
+
+# Source Files
+SOURCES += \
+    main.cpp
@@ -0,0 +1,168 @@
+#include "Common/Common.h"
+#include "Common/FileIO.h"
+#include <cstdio>
+
+/**
+ * Writes pseudo-random values with CBitStreamOutWrapper and reads them back with CBitStreamInWrapper,
+ * for every chunk size and both endiannesses. Values go through WriteBits/ReadBits one at a time and
+ * through WriteBitsArray/ReadBitsArray in runs, at every width from 0 to 32 bits, so array runs start
+ * at arbitrary bit offsets within a chunk.
+ */
+struct SBitValue
+{
+    uint32 NumBits;
+    int32 Value;    // Sign-extended from NumBits, which is what ReadBits returns by default
+    bool InArray;
+};
+
+static uint32 gRandomState = 0x12345678;
+
+static uint32 NextRandom()
+{
+    // xorshift32; deterministic so failures can be reproduced
+    gRandomState ^= gRandomState << 13;
+    gRandomState ^= gRandomState >> 17;
+    gRandomState ^= gRandomState << 5;
+    return gRandomState;
+}
+
+static int32 SignExtend(uint32 Value, uint32 NumBits)
+{
+    if (NumBits == 0) return 0;
+    uint32 Shift = 32 - NumBits;
+    return (int32) (Value << Shift) >> Shift;
+}
+
+static bool TestRoundTrip(CBitStreamOutWrapper::EChunkSize ChunkSize, EEndian Endianness)
+{
+    const char *pkEndianName = (Endianness == EEndian::BigEndian ? "big" : "little");
+    std::vector<SBitValue> Values;
+    std::vector<char> Data;
+    uint64 TotalBits = 0;
+
+    {
+        CVectorOutStream Stream(&Data, Endianness);
+        CBitStreamOutWrapper Writer(&Stream, ChunkSize);
+
+        for (uint32 Iter = 0; Iter < 5000; Iter++)
+        {
+            uint32 NumBits = NextRandom() % 33;
+
+            if (Iter % 20 == 0)
+            {
+                // Array run; the writer should ignore bits above NumBits, so leave them set
+                std::vector<int32> Run(NextRandom() % 40);
+
+                for (uint32 ValIdx = 0; ValIdx < Run.size(); ValIdx++)
+                {
+                    Run[ValIdx] = (int32) NextRandom();
+                    Values.push_back( SBitValue { NumBits, SignExtend((uint32) Run[ValIdx], NumBits), true } );
+                }
+
+                Writer.WriteBitsArray(Run.size(), NumBits, Run.data());
+                TotalBits += (uint64) NumBits * Run.size();
+            }
+            else if (NumBits == 1)
+            {
+                bool Bit = (NextRandom() & 1) != 0;
+                Values.push_back( SBitValue { 1, Bit ? -1 : 0, false } );
+                Writer.WriteBit(Bit);
+                TotalBits++;
+            }
+            else
+            {
+                uint32 Value = NextRandom();
+                Values.push_back( SBitValue { NumBits, SignExtend(Value, NumBits), false } );
+                Writer.WriteBits(Value, NumBits);
+                TotalBits += NumBits;
+            }
+        }
+
+        Writer.Flush();
+    }
+
+    // The last partial chunk should be padded out to exactly one chunk
+    uint64 ExpectedSize = (TotalBits + ChunkSize - 1) / ChunkSize * (ChunkSize / 8);
+
+    if (Data.size() != ExpectedSize)
+    {
+        printf("FAIL: %d-bit chunks, %s endian: wrote %d bytes, expected %d\n", ChunkSize, pkEndianName, (int) Data.size(), (int) ExpectedSize);
+        return false;
+    }
+
+    CMemoryInStream Stream(Data.data(), Data.size(), Endianness);
+    CBitStreamInWrapper Reader(&Stream, (CBitStreamInWrapper::EChunkSize) ChunkSize);
+
+    for (uint32 ValIdx = 0; ValIdx < Values.size(); )
+    {
+        const SBitValue& rkVal = Values[ValIdx];
+
+        if (rkVal.InArray)
+        {
+            // Read the whole run back in one go, alternating signed and unsigned reads
+            uint32 RunEnd = ValIdx;
+            while (RunEnd < Values.size() && Values[RunEnd].InArray && Values[RunEnd].NumBits == rkVal.NumBits && RunEnd - ValIdx < 40)
+                RunEnd++;
+
+            bool ExtendSignBit = (ValIdx % 2 == 0);
+            std::vector<int32> Run(RunEnd - ValIdx);
+            Reader.ReadBitsArray(Run.size(), rkVal.NumBits, Run.data(), ExtendSignBit);
+
+            for (uint32 RunIdx = 0; RunIdx < Run.size(); RunIdx++)
+            {
+                const SBitValue& rkExpected = Values[ValIdx + RunIdx];
+                int32 Expected = (ExtendSignBit || rkExpected.NumBits == 32 ? rkExpected.Value : rkExpected.Value & ((1 << rkExpected.NumBits) - 1));
+
+                if (Run[RunIdx] != Expected)
+                {
+                    printf("FAIL: %d-bit chunks, %s endian: array value %d (%d bits) read back as 0x%08X, expected 0x%08X\n",
+                           ChunkSize, pkEndianName, ValIdx + RunIdx, rkExpected.NumBits, Run[RunIdx], Expected);
+                    return false;
+                }
+            }
+
+            ValIdx = RunEnd;
+        }
+        else
+        {
+            int32 Result = (rkVal.NumBits == 1 ? (Reader.ReadBit() ? -1 : 0) : Reader.ReadBits(rkVal.NumBits));
+
+            if (Result != rkVal.Value)
+            {
+                printf("FAIL: %d-bit chunks, %s endian: value %d (%d bits) read back as 0x%08X, expected 0x%08X\n",
+                       ChunkSize, pkEndianName, ValIdx, rkVal.NumBits, Result, rkVal.Value);
+                return false;
+            }
+
+            ValIdx++;
+        }
+    }
+
+    if (Stream.Tell64() != Data.size())
+    {
+        printf("FAIL: %d-bit chunks, %s endian: reader stopped at byte %d of %d\n", ChunkSize, pkEndianName, (int) Stream.Tell64(), (int) Data.size());
+        return false;
+    }
+
+    printf("OK: %d-bit chunks, %s endian (%d values, %d bytes)\n", ChunkSize, pkEndianName, (int) Values.size(), (int) Data.size());
+    return true;
+}
+
+int main()
+{
+    const CBitStreamOutWrapper::EChunkSize skChunkSizes[] = { CBitStreamOutWrapper::k8Bit, CBitStreamOutWrapper::k16Bit, CBitStreamOutWrapper::k32Bit };
+    const EEndian skEndians[] = { EEndian::LittleEndian, EEndian::BigEndian };
+    uint32 NumFailed = 0;
+
+    for (CBitStreamOutWrapper::EChunkSize ChunkSize : skChunkSizes)
+    {
+        for (EEndian Endianness : skEndians)
+        {
+            if (!TestRoundTrip(ChunkSize, Endianness))
+                NumFailed++;
+        }
+    }
+
+    printf("%d test(s) failed\n", NumFailed);
+    return (NumFailed == 0 ? 0 : 1);
+}